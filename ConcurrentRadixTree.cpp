@@ -0,0 +1,657 @@
+#include "ConcurrentRadixTree.h"
+#include "PrefixMatch.h"
+#include "RadixFormat.h"
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace RadixTreeProject {
+    class ConcurrentRadixTree::ConcurrentImpl {
+        public:
+            /**
+             * @brief Immutable node, allocated as a single block.
+             * The header is followed by the child pointers, the child keys (sorted) and the label bytes.
+             * Nodes are shared between versions of the tree. The reference count covers parents, live roots and snapshots.
+             */
+            struct alignas(8) Node {
+                std::uint32_t labelLength;
+                std::uint32_t wordCount; // Number of words ending at this node or anywhere below it.
+                std::uint16_t childCount;
+                bool isEndOfWord;
+                mutable std::atomic<std::uint32_t> references{1};
+
+                const Node** children() {
+                    return reinterpret_cast<const Node**>(this + 1);
+                }
+
+                const Node* const* children() const {
+                    return reinterpret_cast<const Node* const*>(this + 1);
+                }
+
+                unsigned char* keys() {
+                    return reinterpret_cast<unsigned char*>(children() + childCount);
+                }
+
+                const unsigned char* keys() const {
+                    return reinterpret_cast<const unsigned char*>(children() + childCount);
+                }
+
+                char* label() {
+                    return reinterpret_cast<char*>(keys() + childCount);
+                }
+
+                const char* label() const {
+                    return reinterpret_cast<const char*>(keys() + childCount);
+                }
+
+                // Returns the position of the child stored under the key, childCount if there is none.
+                size_t findChild(unsigned char key) const {
+                    const unsigned char* first = keys();
+                    const unsigned char* found = std::lower_bound(first, first + childCount, key);
+                    size_t position = found - first;
+                    return position < childCount && *found == key ? position : childCount;
+                }
+            };
+
+            /**
+             * @brief Epoch announced by a reader while it is inside the tree, 0 while the slot is free.
+             * Each slot has its own cache line, so readers on different slots don't disturb each other.
+             */
+            struct alignas(64) ReaderSlot {
+                std::atomic<std::uint64_t> epoch{0};
+            };
+
+            static constexpr size_t slotCount = 128;
+            static constexpr size_t reclaimThreshold = 256;
+
+            std::atomic<const Node*> root;
+            std::atomic<std::uint64_t> globalEpoch;
+            std::array<ReaderSlot, slotCount> slots;
+
+            std::mutex writerMutex;
+            std::vector<std::pair<std::uint64_t, const Node*>> retired; // Replaced roots waiting for readers to leave.
+
+            /**
+             * @brief Announces a reader for as long as it exists, keeping the nodes it can reach alive.
+             */
+            class ReadGuard {
+                private:
+                    ConcurrentImpl& impl;
+                    size_t slot;
+
+                public:
+                    explicit ReadGuard(ConcurrentImpl& concurrentImpl) : impl(concurrentImpl), slot(concurrentImpl.enter()) {
+
+                    }
+
+                    ~ReadGuard() {
+                        impl.slots[slot].epoch.store(0, std::memory_order_release);
+                    }
+
+                    ReadGuard(const ReadGuard&) = delete;
+                    ReadGuard& operator=(const ReadGuard&) = delete;
+            };
+
+            explicit ConcurrentImpl(const Node* sharedRoot = makeNode("", 0, 0)) : root(sharedRoot), globalEpoch(1) {
+
+            }
+
+            ~ConcurrentImpl() {
+                release(root.load());
+                for (const auto& [epoch, oldRoot] : retired) {
+                    release(oldRoot);
+                }
+            }
+
+            /**
+             * @brief Takes a reference to the current root, for a snapshot or a copy of the tree.
+             * The read guard keeps the root alive until the reference is taken.
+             */
+            const Node* shareRoot() {
+                ReadGuard guard(*this);
+                const Node* current = root.load();
+                acquire(current);
+                return current;
+            }
+
+            /**
+             * @brief Claims a free reader slot and publishes the current epoch in it.
+             * The slot is picked by thread, so a thread keeps hitting the same cache line.
+             * @return Index of the claimed slot.
+             */
+            size_t enter() {
+                thread_local const size_t preferredSlot = std::hash<std::thread::id>()(std::this_thread::get_id());
+                size_t slot = preferredSlot % slotCount;
+                for (;;) {
+                    std::uint64_t idle = 0;
+                    if (slots[slot].epoch.compare_exchange_strong(idle, globalEpoch.load())) {
+                        return slot;
+                    }
+                    slot = (slot + 1) % slotCount;
+                }
+            }
+
+            // Allocates a node with room for the given label and number of children, owned by its creator.
+            static Node* makeNode(const char* label, size_t labelLength, size_t childCount) {
+                size_t bytes = sizeof(Node) + childCount * (sizeof(const Node*) + 1) + labelLength;
+                Node* node = new (::operator new(bytes)) Node;
+                node->labelLength = static_cast<std::uint32_t>(labelLength);
+                node->wordCount = 0;
+                node->childCount = static_cast<std::uint16_t>(childCount);
+                node->isEndOfWord = false;
+                std::memcpy(node->label(), label, labelLength);
+                return node;
+            }
+
+            static void acquire(const Node* node) {
+                node->references.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Drops one reference, freeing the node and releasing its children when it was the last one.
+            static void release(const Node* node) {
+                if (node->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                    return;
+                }
+                for (size_t i = 0; i < node->childCount; ++i) {
+                    release(node->children()[i]);
+                }
+                node->~Node();
+                ::operator delete(const_cast<Node*>(node));
+            }
+
+            // A copied node shares the children it took over, except the one at the given position.
+            static void shareChildren(const Node* copy, size_t except = SIZE_MAX) {
+                for (size_t i = 0; i < copy->childCount; ++i) {
+                    if (i != except) {
+                        acquire(copy->children()[i]);
+                    }
+                }
+            }
+
+            // Sets a node's word count from its own marker and its children's counts.
+            static void recount(Node* node) {
+                std::uint32_t count = node->isEndOfWord;
+                for (size_t i = 0; i < node->childCount; ++i) {
+                    count += node->children()[i]->wordCount;
+                }
+                node->wordCount = count;
+            }
+
+            // Copies a node with a different label.
+            static Node* relabel(const Node* node, const char* label, size_t labelLength) {
+                Node* copy = makeNode(label, labelLength, node->childCount);
+                std::copy(node->children(), node->children() + node->childCount, copy->children());
+                std::copy(node->keys(), node->keys() + node->childCount, copy->keys());
+                copy->isEndOfWord = node->isEndOfWord;
+                copy->wordCount = node->wordCount;
+                shareChildren(copy);
+                return copy;
+            }
+
+            // Copies a node, replacing the child stored under the key or adding it if there is none.
+            static Node* withChild(const Node* node, unsigned char key, const Node* child) {
+                size_t position = node->findChild(key);
+                bool adding = position == node->childCount;
+                if (adding) {
+                    position = std::lower_bound(node->keys(), node->keys() + node->childCount, key) - node->keys();
+                }
+
+                Node* copy = makeNode(node->label(), node->labelLength, node->childCount + adding);
+                std::copy(node->children(), node->children() + position, copy->children());
+                std::copy(node->keys(), node->keys() + position, copy->keys());
+                copy->children()[position] = child;
+                copy->keys()[position] = key;
+                size_t rest = position + !adding;
+                std::copy(node->children() + rest, node->children() + node->childCount, copy->children() + position + 1);
+                std::copy(node->keys() + rest, node->keys() + node->childCount, copy->keys() + position + 1);
+                copy->isEndOfWord = node->isEndOfWord;
+                recount(copy);
+                shareChildren(copy, position);
+                return copy;
+            }
+
+            // Copies a node without the child at the given position.
+            static Node* withoutChild(const Node* node, size_t position) {
+                Node* copy = makeNode(node->label(), node->labelLength, node->childCount - 1);
+                std::copy(node->children(), node->children() + position, copy->children());
+                std::copy(node->keys(), node->keys() + position, copy->keys());
+                std::copy(node->children() + position + 1, node->children() + node->childCount, copy->children() + position);
+                std::copy(node->keys() + position + 1, node->keys() + node->childCount, copy->keys() + position);
+                copy->isEndOfWord = node->isEndOfWord;
+                recount(copy);
+                shareChildren(copy);
+                return copy;
+            }
+
+            // Joins a pass-through node with its only child, keeping the path compressed.
+            static Node* joinWithChild(const Node* node, const Node* child) {
+                std::string label(node->label(), node->labelLength);
+                label.append(child->label(), child->labelLength);
+                return relabel(child, label.data(), label.size());
+            }
+
+            /**
+             * @brief Walks down from a node along the given text.
+             * @param allowPartial Whether the text may end in the middle of a node's label.
+             * @param labelStart Receives the position in the text where the returned node's label starts.
+             * @return The node where the text ends, nullptr if the text leaves the tree.
+             */
+            static const Node* descend(const Node* node, std::string_view text, bool allowPartial, size_t& labelStart) {
+                size_t index = 0;
+                labelStart = 0;
+                while (index < text.size()) {
+                    size_t position = node->findChild(text[index]);
+                    if (position == node->childCount) {
+                        return nullptr;
+                    }
+
+                    const Node* child = node->children()[position];
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->label(), text.data() + index, std::min<size_t>(child->labelLength, text.size() - index));
+                    if (matchingLength != child->labelLength && !(allowPartial && index + matchingLength == text.size())) {
+                        return nullptr;
+                    }
+
+                    node = child;
+                    labelStart = index;
+                    index += matchingLength;
+                }
+                return node;
+            }
+
+            /**
+             * @brief Copies the path from a node down to where the word belongs, adding the word on the way.
+             * The word must not be in the tree yet. Everything off the path is shared with the old version.
+             * @return The copy replacing the node.
+             */
+            static const Node* insertInto(const Node* node, std::string_view word, size_t index) {
+                if (index == word.size()) {
+                    Node* copy = relabel(node, node->label(), node->labelLength);
+                    copy->isEndOfWord = true;
+                    ++copy->wordCount;
+                    return copy;
+                }
+
+                unsigned char key = word[index];
+                size_t position = node->findChild(key);
+                if (position == node->childCount) {
+                    Node* leaf = makeNode(word.data() + index, word.size() - index, 0);
+                    leaf->isEndOfWord = true;
+                    leaf->wordCount = 1;
+                    return withChild(node, key, leaf);
+                }
+
+                const Node* child = node->children()[position];
+                size_t matchingLength = PrefixMatch::commonPrefixLength(child->label(), word.data() + index, std::min<size_t>(child->labelLength, word.size() - index));
+
+                if (matchingLength == child->labelLength) {
+                    return withChild(node, key, insertInto(child, word, index + matchingLength));
+                }
+
+                // The word ends or branches off inside the child's label, so the child is split there.
+                const Node* lower = relabel(child, child->label() + matchingLength, child->labelLength - matchingLength);
+                bool branching = index + matchingLength < word.size();
+                Node* upper = makeNode(child->label(), matchingLength, branching ? 2 : 1);
+                if (branching) {
+                    Node* leaf = makeNode(word.data() + index + matchingLength, word.size() - index - matchingLength, 0);
+                    leaf->isEndOfWord = true;
+                    leaf->wordCount = 1;
+                    bool leafFirst = static_cast<unsigned char>(leaf->label()[0]) < static_cast<unsigned char>(lower->label()[0]);
+                    upper->children()[leafFirst ? 0 : 1] = leaf;
+                    upper->keys()[leafFirst ? 0 : 1] = leaf->label()[0];
+                    upper->children()[leafFirst ? 1 : 0] = lower;
+                    upper->keys()[leafFirst ? 1 : 0] = lower->label()[0];
+                }
+                else {
+                    upper->children()[0] = lower;
+                    upper->keys()[0] = lower->label()[0];
+                    upper->isEndOfWord = true;
+                }
+                recount(upper);
+                return withChild(node, key, upper);
+            }
+
+            /**
+             * @brief Copies the path from a node down to the word, removing the word on the way.
+             * The word must be in the tree. Nodes left without words are dropped and pass-through nodes are joined with their child.
+             * @return The copy replacing the node, nullptr if the node isn't needed any more.
+             */
+            static const Node* removeFrom(const Node* node, std::string_view word, size_t index, bool isRoot) {
+                if (index == word.size()) {
+                    if (!isRoot && node->childCount == 0) {
+                        return nullptr;
+                    }
+                    if (!isRoot && node->childCount == 1) {
+                        return joinWithChild(node, node->children()[0]);
+                    }
+                    Node* copy = relabel(node, node->label(), node->labelLength);
+                    copy->isEndOfWord = false;
+                    --copy->wordCount;
+                    return copy;
+                }
+
+                unsigned char key = word[index];
+                size_t position = node->findChild(key);
+                const Node* child = node->children()[position];
+                const Node* newChild = removeFrom(child, word, index + child->labelLength, false);
+                if (newChild) {
+                    return withChild(node, key, newChild);
+                }
+
+                if (!isRoot && !node->isEndOfWord && node->childCount == 2) {
+                    return joinWithChild(node, node->children()[1 - position]);
+                }
+                return withoutChild(node, position);
+            }
+
+            /**
+             * @brief Publishes a new root and retires the old one.
+             * The old root is tagged with the current epoch and released once every reader has moved past it.
+             * Releasing it frees the nodes of the old path that no other version of the tree still shares.
+             */
+            void publish(const Node* newRoot) {
+                const Node* oldRoot = root.load();
+                root.store(newRoot);
+                retired.emplace_back(globalEpoch.load(), oldRoot);
+                globalEpoch.fetch_add(1);
+
+                if (retired.size() >= reclaimThreshold) {
+                    reclaim();
+                }
+            }
+
+            static bool contains(const Node* root, std::string_view word) {
+                size_t labelStart;
+                const Node* node = descend(root, word, false, labelStart);
+                return node && node->isEndOfWord;
+            }
+
+            static size_t countWithPrefix(const Node* root, std::string_view prefix) {
+                size_t labelStart;
+                const Node* node = descend(root, prefix, true, labelStart);
+                return node ? node->wordCount : 0;
+            }
+
+            static size_t forEachWithPrefix(const Node* root, std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) {
+                size_t labelStart;
+                const Node* node = descend(root, prefix, true, labelStart);
+                if (!node) {
+                    return 0;
+                }
+
+                // Depth-first walk with an explicit stack and a single reused word buffer, as in MappedRadixTree.
+                ValueType word(prefix.substr(0, labelStart));
+                std::vector<std::pair<const Node*, size_t>> stack;
+                stack.emplace_back(node, word.size());
+                size_t reported = 0;
+                while (!stack.empty() && reported < limit) {
+                    auto [current, bufferLength] = stack.back();
+                    stack.pop_back();
+
+                    word.resize(bufferLength);
+                    word.append(current->label(), current->labelLength);
+                    if (current->isEndOfWord) {
+                        callback(word);
+                        ++reported;
+                    }
+                    for (size_t i = current->childCount; i > 0; --i) {
+                        stack.emplace_back(current->children()[i - 1], word.size());
+                    }
+                }
+                return reported;
+            }
+
+            // Writes the version below a root in RadixFormat, nodes in breadth-first order as RadixTree::save lays them out.
+            static void save(const Node* root, const std::string& path) {
+                std::vector<const Node*> order;
+                order.push_back(root);
+                std::vector<RadixFormat::FileNode> fileNodes;
+                std::uint64_t labelBytes = 0;
+                for (size_t i = 0; i < order.size(); ++i) {
+                    const Node* node = order[i];
+                    RadixFormat::FileNode fileNode{};
+                    fileNode.labelOffset = labelBytes;
+                    fileNode.labelLength = node->labelLength;
+                    fileNode.firstChild = static_cast<std::uint32_t>(order.size());
+                    fileNode.childCount = node->childCount;
+                    fileNode.isEndOfWord = node->isEndOfWord;
+                    fileNodes.push_back(fileNode);
+                    labelBytes += node->labelLength;
+                    order.insert(order.end(), node->children(), node->children() + node->childCount);
+                }
+
+                if (order.size() > UINT32_MAX) {
+                    throw MyException("The tree has too many nodes to be saved");
+                }
+
+                RadixFormat::FileHeader header{};
+                std::memcpy(header.magic, RadixFormat::magic, sizeof(header.magic));
+                header.version = RadixFormat::version;
+                header.byteOrderMark = RadixFormat::byteOrderMark;
+                header.nodeCount = order.size();
+                header.wordCount = root->wordCount;
+                header.nodesOffset = sizeof(header);
+                header.keysOffset = header.nodesOffset + order.size() * sizeof(RadixFormat::FileNode);
+                header.labelsOffset = header.keysOffset + order.size();
+                header.labelBytes = labelBytes;
+
+                std::string keys(order.size(), '\0');
+                for (size_t i = 1; i < order.size(); ++i) {
+                    keys[i] = order[i]->label()[0];
+                }
+                bool replaced = RadixFormat::replaceFile(path, [&](std::ofstream& file) {
+                    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                    file.write(reinterpret_cast<const char*>(fileNodes.data()), fileNodes.size() * sizeof(RadixFormat::FileNode));
+                    file.write(keys.data(), keys.size());
+                    for (const Node* node : order) {
+                        file.write(node->label(), node->labelLength);
+                    }
+                });
+                if (!replaced) {
+                    throw MyException("Couldn't write the tree to " + path);
+                }
+            }
+
+            /**
+             * @brief Builds nodes from a saved tree, children before their parents.
+             * @param data The file, checked by RadixFormat::isValidLayout.
+             * @return The new root.
+             */
+            static const Node* build(const std::vector<char>& data) {
+                RadixFormat::FileHeader header;
+                std::memcpy(&header, data.data(), sizeof(header));
+                std::vector<RadixFormat::FileNode> fileNodes(header.nodeCount);
+                std::memcpy(fileNodes.data(), data.data() + header.nodesOffset, fileNodes.size() * sizeof(RadixFormat::FileNode));
+                const char* labels = data.data() + header.labelsOffset;
+
+                std::vector<Node*> built(fileNodes.size(), nullptr);
+                for (size_t i = fileNodes.size(); i-- > 0;) {
+                    const RadixFormat::FileNode& fileNode = fileNodes[i];
+                    Node* node = makeNode(labels + fileNode.labelOffset, fileNode.labelLength, fileNode.childCount);
+                    node->isEndOfWord = fileNode.isEndOfWord;
+                    for (size_t j = 0; j < fileNode.childCount; ++j) {
+                        Node* child = built[fileNode.firstChild + j];
+                        node->children()[j] = child;
+                        node->keys()[j] = child->label()[0];
+                    }
+                    recount(node);
+                    built[i] = node;
+                }
+                return built[0];
+            }
+
+            // Releases every retired root that no active reader can reach any more.
+            void reclaim() {
+                std::uint64_t oldestActive = UINT64_MAX;
+                for (const ReaderSlot& slot : slots) {
+                    std::uint64_t epoch = slot.epoch.load();
+                    if (epoch != 0) {
+                        oldestActive = std::min(oldestActive, epoch);
+                    }
+                }
+
+                auto stillNeeded = std::partition(retired.begin(), retired.end(), [&](const std::pair<std::uint64_t, const Node*>& entry) {
+                    return entry.first >= oldestActive;
+                });
+                for (auto entry = stillNeeded; entry != retired.end(); ++entry) {
+                    release(entry->second);
+                }
+                retired.erase(stillNeeded, retired.end());
+            }
+    };
+
+    /**
+     * @brief Holds one reference to the root of the version a snapshot was taken of.
+     */
+    class ConcurrentRadixTree::Snapshot::SnapshotImpl {
+        public:
+            const ConcurrentImpl::Node* root;
+
+            explicit SnapshotImpl(const ConcurrentImpl::Node* sharedRoot) : root(sharedRoot) {
+
+            }
+
+            ~SnapshotImpl() {
+                ConcurrentImpl::release(root);
+            }
+
+            SnapshotImpl(const SnapshotImpl&) = delete;
+            SnapshotImpl& operator=(const SnapshotImpl&) = delete;
+    };
+
+    ConcurrentRadixTree::Snapshot::Snapshot(std::shared_ptr<const SnapshotImpl> impl) : pImpl(std::move(impl)) {
+
+    }
+
+    bool ConcurrentRadixTree::Snapshot::search(std::string_view word) const {
+        return ConcurrentImpl::contains(pImpl->root, word);
+    }
+
+    bool ConcurrentRadixTree::Snapshot::hasPrefix(std::string_view prefix) const {
+        return countWithPrefix(prefix) > 0;
+    }
+
+    size_t ConcurrentRadixTree::Snapshot::countWithPrefix(std::string_view prefix) const {
+        return ConcurrentImpl::countWithPrefix(pImpl->root, prefix);
+    }
+
+    size_t ConcurrentRadixTree::Snapshot::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        return ConcurrentImpl::forEachWithPrefix(pImpl->root, prefix, callback, limit);
+    }
+
+    size_t ConcurrentRadixTree::Snapshot::size() const {
+        return pImpl->root->wordCount;
+    }
+
+    void ConcurrentRadixTree::Snapshot::save(const std::string& path) const {
+        ConcurrentImpl::save(pImpl->root, path);
+    }
+
+    bool ConcurrentRadixTree::Snapshot::operator[](std::string_view word) const {
+        return search(word);
+    }
+
+    ConcurrentRadixTree::ConcurrentRadixTree() : pImpl(std::make_unique<ConcurrentImpl>()) {
+
+    }
+
+    ConcurrentRadixTree::ConcurrentRadixTree(const ConcurrentRadixTree& other) : pImpl(std::make_unique<ConcurrentImpl>(other.pImpl->shareRoot())) {
+
+    }
+
+    ConcurrentRadixTree& ConcurrentRadixTree::operator=(const ConcurrentRadixTree& other) {
+        if (this != &other) {
+            const ConcurrentImpl::Node* sharedRoot = other.pImpl->shareRoot();
+            std::lock_guard<std::mutex> lock(pImpl->writerMutex);
+            pImpl->publish(sharedRoot);
+        }
+        return *this;
+    }
+
+    ConcurrentRadixTree::~ConcurrentRadixTree() = default;
+
+    void ConcurrentRadixTree::load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw MyException("Couldn't open " + path);
+        }
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const ConcurrentImpl::Node* loadedRoot = RadixFormat::isValidLayout(data.data(), data.size()) ? ConcurrentImpl::build(data) : nullptr;
+        if (!loadedRoot) {
+            throw MyException(path + " isn't a saved radix tree");
+        }
+        std::lock_guard<std::mutex> lock(pImpl->writerMutex);
+        pImpl->publish(loadedRoot);
+    }
+
+    ConcurrentRadixTree::Snapshot ConcurrentRadixTree::snapshot() const {
+        return Snapshot(std::make_shared<const Snapshot::SnapshotImpl>(pImpl->shareRoot()));
+    }
+
+    void ConcurrentRadixTree::insert(std::string_view word) {
+        if (!tryInsert(word)) {
+            throw MyException("The word already exists in the tree");
+        }
+    }
+
+    bool ConcurrentRadixTree::tryInsert(std::string_view word) {
+        std::lock_guard<std::mutex> lock(pImpl->writerMutex);
+        const ConcurrentImpl::Node* root = pImpl->root.load();
+        if (ConcurrentImpl::contains(root, word)) {
+            return false;
+        }
+        pImpl->publish(ConcurrentImpl::insertInto(root, word, 0));
+        return true;
+    }
+
+    void ConcurrentRadixTree::remove(std::string_view word) {
+        if (!tryRemove(word)) {
+            throw MyException("Word not found. Couldn't remove");
+        }
+    }
+
+    bool ConcurrentRadixTree::tryRemove(std::string_view word) {
+        std::lock_guard<std::mutex> lock(pImpl->writerMutex);
+        const ConcurrentImpl::Node* root = pImpl->root.load();
+        if (!ConcurrentImpl::contains(root, word)) {
+            return false;
+        }
+        pImpl->publish(ConcurrentImpl::removeFrom(root, word, 0, true));
+        return true;
+    }
+
+    bool ConcurrentRadixTree::search(std::string_view word) const {
+        ConcurrentImpl::ReadGuard guard(*pImpl);
+        return ConcurrentImpl::contains(pImpl->root.load(), word);
+    }
+
+    bool ConcurrentRadixTree::hasPrefix(std::string_view prefix) const {
+        return countWithPrefix(prefix) > 0;
+    }
+
+    size_t ConcurrentRadixTree::countWithPrefix(std::string_view prefix) const {
+        ConcurrentImpl::ReadGuard guard(*pImpl);
+        return ConcurrentImpl::countWithPrefix(pImpl->root.load(), prefix);
+    }
+
+    size_t ConcurrentRadixTree::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        ConcurrentImpl::ReadGuard guard(*pImpl);
+        return ConcurrentImpl::forEachWithPrefix(pImpl->root.load(), prefix, callback, limit);
+    }
+
+    size_t ConcurrentRadixTree::size() const {
+        ConcurrentImpl::ReadGuard guard(*pImpl);
+        return pImpl->root.load()->wordCount;
+    }
+
+    bool ConcurrentRadixTree::operator[](std::string_view word) const {
+        return search(word);
+    }
+}
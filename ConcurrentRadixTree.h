@@ -0,0 +1,198 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef CONCURRENT_RADIX_H
+#define CONCURRENT_RADIX_H
+
+#include "RadixTree.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace RadixTreeProject {
+
+    /**
+     * @class ConcurrentRadixTree
+     * @brief Radix tree for read-mostly workloads shared between threads.
+     *
+     * Readers never take a lock. Nodes are immutable once published: writers are serialized by a mutex,
+     * copy the path from the root down to the node they change and publish the new root atomically.
+     * Every other node is shared with the previous version, so snapshots and copies of the tree cost O(1)
+     * and only the changed paths take extra memory. Nodes are reference counted; a replaced root is released
+     * with epoch-based reclamation once no reader can still be looking at it.
+     * Implementation of the class is hidden using the PImpl idiom.
+     */
+    class ConcurrentRadixTree {
+        private:
+            class ConcurrentImpl;
+            std::unique_ptr<ConcurrentImpl> pImpl;
+
+        public:
+            using ValueType = RadixTree::ValueType;
+
+            /**
+             * @class Snapshot
+             * @brief Immutable view of the tree as it was when the snapshot was taken.
+             * Later changes to the tree don't affect it. Copies share the same view, and it stays valid
+             * after the tree itself is destroyed. Any number of threads may query it at once.
+             */
+            class Snapshot {
+                private:
+                    class SnapshotImpl;
+                    std::shared_ptr<const SnapshotImpl> pImpl;
+
+                    explicit Snapshot(std::shared_ptr<const SnapshotImpl> impl);
+                    friend class ConcurrentRadixTree;
+
+                public:
+                    /**
+                     * @brief Searches for a word in the snapshot.
+                     * @param word The word to search.
+                     * @return True if the word existed when the snapshot was taken, false otherwise.
+                     */
+                    bool search(std::string_view word) const;
+
+                    /**
+                     * @brief Checks whether any word in the snapshot starts with the given prefix.
+                     */
+                    bool hasPrefix(std::string_view prefix) const;
+
+                    /**
+                     * @brief Counts the words in the snapshot starting with the given prefix in O(|prefix|) time.
+                     */
+                    size_t countWithPrefix(std::string_view prefix) const;
+
+                    /**
+                     * @brief Calls the callback for every word in the snapshot starting with the given prefix, in lexicographic order.
+                     * @return Number of words reported.
+                     */
+                    size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+                    /**
+                     * @brief Returns the number of words in the snapshot.
+                     */
+                    size_t size() const;
+
+                    /**
+                     * @brief Writes the snapshot to a file in the format of RadixTree::save, which MappedRadixTree can map.
+                     * Writers of the tree go on while the file is written.
+                     * @param path Path of the file to write, an existing file is overwritten.
+                     * @throws an exception if the file can't be written.
+                     */
+                    void save(const std::string& path) const;
+
+                    bool operator[](std::string_view word) const;
+            };
+
+            // Creates an empty tree.
+            ConcurrentRadixTree();
+
+            /**
+             * @brief Copy constructor - shares every node with the other tree in O(1) time.
+             * The trees diverge as either of them changes.
+             */
+            ConcurrentRadixTree(const ConcurrentRadixTree& other);
+
+            /**
+             * @brief Copy assignment operator - replaces the contents with the other tree's nodes in O(1) time.
+             * Readers of this tree see either the old or the new contents.
+             */
+            ConcurrentRadixTree& operator=(const ConcurrentRadixTree& other);
+
+            /**
+             * @brief Destructor - releases the tree's nodes. No thread may use the tree any more,
+             * but snapshots taken from it stay valid.
+             */
+            ~ConcurrentRadixTree();
+
+            /**
+             * @brief Takes an immutable snapshot of the current contents in O(1) time.
+             */
+            Snapshot snapshot() const;
+
+            /**
+             * @brief Inserts a new word into the tree.
+             * @param word The word to insert into the tree.
+             * @throws an exception if the word already exists.
+             */
+            void insert(std::string_view word);
+
+            /**
+             * @brief Inserts a word unless it is already in the tree, without throwing.
+             * @param word The word to insert into the tree.
+             * @return True if the word was added, false if it already existed.
+             */
+            bool tryInsert(std::string_view word);
+
+            /**
+             * @brief Removes a given word from the tree.
+             * @param word The word to remove from the tree.
+             * @throws an exception if the word doesn't exist in the tree.
+             */
+            void remove(std::string_view word);
+
+            /**
+             * @brief Removes a word if it is in the tree, without throwing.
+             * @param word The word to remove from the tree.
+             * @return True if the word was removed, false if it wasn't in the tree.
+             */
+            bool tryRemove(std::string_view word);
+
+            /**
+             * @brief Replaces the contents with a tree saved by RadixTree::save or Snapshot::save.
+             * Readers see either the old or the new contents.
+             * @param path Path of the saved tree.
+             * @throws an exception if the file can't be read or isn't a well formed saved tree.
+             */
+            void load(const std::string& path);
+
+            /**
+             * @brief Searches for a word in the tree without taking any lock.
+             * @param word The word to search in the tree.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool search(std::string_view word) const;
+
+            /**
+             * @brief Checks whether any word in the tree starts with the given prefix.
+             * @param prefix The prefix to look for.
+             * @return True if at least one word starts with the prefix, false otherwise.
+             */
+            bool hasPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Counts the words starting with the given prefix in O(|prefix|) time.
+             * @param prefix The prefix the words have to start with.
+             * @return Number of words starting with the prefix.
+             */
+            size_t countWithPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Calls the callback for every word starting with the given prefix, in lexicographic order.
+             * The words come from a single consistent version of the tree, even if writers change it meanwhile.
+             * The callback must not modify the tree.
+             * @param prefix The prefix the words have to start with.
+             * @param callback Function called with each matching word.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Returns the number of words stored in the tree.
+             */
+            size_t size() const;
+
+            /**
+             * @brief Searches for the given word in the tree.
+             * @param word The word to be searched.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool operator[](std::string_view word) const;
+    };
+}
+
+#endif
@@ -0,0 +1,595 @@
+#include "DurableRadixTree.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RadixTreeProject {
+    namespace {
+        namespace fs = std::filesystem;
+
+        /**
+         * Log file layout: the magic, then one record per change:
+         * [checksum: uint32][word length, with the top bit set for a removal: uint32][word bytes]
+         * The checksum covers the length field and the word, so a record torn by a crash is recognized and dropped.
+         * Integers are stored in the byte order of the machine, as in RadixFormat.
+         */
+        constexpr char logMagic[8] = {'R', 'A', 'D', 'I', 'X', 'L', 'O', 'G'};
+        constexpr std::uint32_t removalFlag = 0x80000000u;
+        constexpr size_t recordHeaderSize = 2 * sizeof(std::uint32_t);
+
+        // FNV-1a over the length field and the word.
+        std::uint32_t checksum(std::uint32_t lengthField, std::string_view word) {
+            std::uint32_t hash = 2166136261u;
+            auto mix = [&](unsigned char byte) {
+                hash = (hash ^ byte) * 16777619u;
+            };
+            for (size_t i = 0; i < sizeof(lengthField); ++i) {
+                mix(static_cast<unsigned char>(lengthField >> (8 * i)));
+            }
+            for (char c : word) {
+                mix(static_cast<unsigned char>(c));
+            }
+            return hash;
+        }
+
+        /**
+         * File names carry a generation: checkpoint-<g>.rdx holds every change logged before log-<g>.wal was started.
+         */
+        std::string fileName(const char* prefix, std::uint64_t generation, const char* suffix) {
+            return prefix + std::to_string(generation) + suffix;
+        }
+
+        bool parseGeneration(const std::string& name, const std::string& prefix, const std::string& suffix, std::uint64_t& generation) {
+            if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                return false;
+            }
+            std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+            if (!std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                return false;
+            }
+            generation = std::stoull(digits);
+            return true;
+        }
+
+        /**
+         * Thin wrappers over the system calls the log needs: std::fstream can't sync a file to the disk.
+         */
+        int openFile(const fs::path& path, bool create) {
+#ifdef _WIN32
+            int fd = ::_open(path.string().c_str(), create ? _O_WRONLY | _O_CREAT | _O_TRUNC | _O_APPEND | _O_BINARY : _O_RDONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+            int fd = ::open(path.c_str(), create ? O_WRONLY | O_CREAT | O_TRUNC | O_APPEND : O_RDONLY, 0644);
+#endif
+            if (fd < 0) {
+                throw MyException("Couldn't open " + path.string());
+            }
+            return fd;
+        }
+
+        void closeFile(int fd) {
+#ifdef _WIN32
+            ::_close(fd);
+#else
+            ::close(fd);
+#endif
+        }
+
+        void writeAll(int fd, const char* data, size_t length) {
+            while (length > 0) {
+#ifdef _WIN32
+                int written = ::_write(fd, data, static_cast<unsigned>(std::min<size_t>(length, 1 << 30)));
+#else
+                ssize_t written = ::write(fd, data, length);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+#endif
+                if (written < 0) {
+                    throw MyException("Couldn't write the log");
+                }
+                data += written;
+                length -= static_cast<size_t>(written);
+            }
+        }
+
+        void syncFile(int fd) {
+#ifdef _WIN32
+            int result = ::_commit(fd);
+#elif defined(__linux__)
+            int result = ::fdatasync(fd);
+#else
+            int result = ::fsync(fd);
+#endif
+            if (result != 0) {
+                throw MyException("Couldn't sync the log");
+            }
+        }
+
+        // Syncs a file that was written through a stream.
+        void syncPath(const fs::path& path) {
+            int fd = openFile(path, false);
+            try {
+                syncFile(fd);
+            }
+            catch (...) {
+                closeFile(fd);
+                throw;
+            }
+            closeFile(fd);
+        }
+
+        // Makes created, renamed and removed directory entries durable. Windows has no equivalent, there it does nothing.
+        void syncDirectory(const fs::path& directory) {
+#ifndef _WIN32
+            int fd = ::open(directory.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                ::fsync(fd);
+                ::close(fd);
+            }
+#else
+            (void)directory;
+#endif
+        }
+    }
+
+    class DurableRadixTree::DurableImpl {
+        public:
+            fs::path directory;
+            Options options;
+            ConcurrentRadixTree tree;
+            RecoveryStatistics recovered;
+
+            // Orders the changes to the tree and their log records the same way.
+            std::mutex writeMutex;
+
+            // Everything below is guarded by the log mutex.
+            std::mutex logMutex;
+            std::condition_variable logSynced;
+            std::condition_variable backgroundWork;
+            int logFd = -1;
+            std::uint64_t generation = 0; // Generation of the current log.
+            std::string pending; // Records appended but not written yet.
+            std::uint64_t appended = 0; // Records appended so far.
+            std::uint64_t durable = 0; // Records written and synced so far.
+            bool flushing = false;
+            std::uint64_t logBytes = 0; // Bytes logged since the last checkpoint began.
+            std::string failure; // Set once writing the log failed; every later change fails too.
+            std::exception_ptr backgroundFailure; // A background checkpoint that failed, rethrown by sync and checkpoint.
+            bool checkpointRequested = false;
+            bool stopping = false;
+
+            std::mutex checkpointMutex; // One checkpoint at a time.
+            std::thread checkpointer;
+            std::thread flusher;
+
+            DurableImpl(const std::string& path, const Options& durabilityOptions) : directory(path), options(durabilityOptions) {
+                recover();
+                checkpointer = std::thread([this] {
+                    runCheckpoints();
+                });
+                if (!options.synchronous) {
+                    flusher = std::thread([this] {
+                        runFlushes();
+                    });
+                }
+            }
+
+            ~DurableImpl() {
+                {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    stopping = true;
+                }
+                backgroundWork.notify_all();
+                checkpointer.join();
+                if (flusher.joinable()) {
+                    flusher.join();
+                }
+                try {
+                    std::unique_lock<std::mutex> lock(logMutex);
+                    flush(lock);
+                }
+                catch (const MyException&) {
+                    // Nothing left to report the failure to; the changes are lost as in a crash.
+                }
+                closeFile(logFd);
+            }
+
+            // Creates the log of a generation, with its magic already synced.
+            int createLog(std::uint64_t logGeneration) {
+                int fd = openFile(directory / fileName("log-", logGeneration, ".wal"), true);
+                try {
+                    writeAll(fd, logMagic, sizeof(logMagic));
+                    syncFile(fd);
+                }
+                catch (...) {
+                    closeFile(fd);
+                    throw;
+                }
+                syncDirectory(directory);
+                return fd;
+            }
+
+            /**
+             * @brief Loads the newest checkpoint, replays the logs of its generation and later ones, and starts a new log.
+             * Files a crash left behind, like unfinished checkpoints and logs older than the newest checkpoint, are removed.
+             */
+            void recover() {
+                fs::create_directories(directory);
+                std::vector<std::uint64_t> checkpoints;
+                std::vector<std::uint64_t> logs;
+                for (const auto& entry : fs::directory_iterator(directory)) {
+                    std::string name = entry.path().filename().string();
+                    std::uint64_t found;
+                    if (parseGeneration(name, "checkpoint-", ".rdx", found)) {
+                        checkpoints.push_back(found);
+                    }
+                    else if (parseGeneration(name, "log-", ".wal", found)) {
+                        logs.push_back(found);
+                    }
+                    // Checkpoints left unfinished by a crash, including the temporary file Snapshot::save writes through.
+                    else if (parseGeneration(name, "checkpoint-", ".rdx.tmp", found) || parseGeneration(name, "checkpoint-", ".rdx.tmp.tmp", found)) {
+                        fs::remove(entry.path());
+                    }
+                }
+                std::sort(checkpoints.begin(), checkpoints.end());
+                std::sort(logs.begin(), logs.end());
+
+                // Older checkpoints are only removed once a newer one is in place, so a damaged newest one is real damage.
+                std::uint64_t base = 0;
+                if (!checkpoints.empty()) {
+                    base = checkpoints.back();
+                    tree.load((directory / fileName("checkpoint-", base, ".rdx")).string());
+                    recovered.checkpointWords = tree.size();
+                }
+                for (std::uint64_t logGeneration : logs) {
+                    if (logGeneration >= base) {
+                        replay(directory / fileName("log-", logGeneration, ".wal"));
+                    }
+                }
+                removeObsolete(base);
+
+                generation = std::max(base, logs.empty() ? 0 : logs.back()) + 1;
+                logFd = createLog(generation);
+            }
+
+            // Applies the records of a log, stopping at the first one that is incomplete or fails its checksum.
+            void replay(const fs::path& path) {
+                std::ifstream file(path, std::ios::binary);
+                if (!file) {
+                    throw MyException("Couldn't open " + path.string());
+                }
+                std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                logBytes += data.size();
+                if (data.size() < sizeof(logMagic) || std::memcmp(data.data(), logMagic, sizeof(logMagic)) != 0) {
+                    // A crash right after the file was created; nothing was logged into it.
+                    recovered.discardedBytes += data.size();
+                    return;
+                }
+
+                size_t position = sizeof(logMagic);
+                while (data.size() - position >= recordHeaderSize) {
+                    std::uint32_t storedChecksum;
+                    std::uint32_t lengthField;
+                    std::memcpy(&storedChecksum, data.data() + position, sizeof(storedChecksum));
+                    std::memcpy(&lengthField, data.data() + position + sizeof(storedChecksum), sizeof(lengthField));
+                    size_t length = lengthField & ~removalFlag;
+                    if (data.size() - position - recordHeaderSize < length) {
+                        break;
+                    }
+                    std::string_view word(data.data() + position + recordHeaderSize, length);
+                    if (checksum(lengthField, word) != storedChecksum) {
+                        break;
+                    }
+                    if (lengthField & removalFlag) {
+                        tree.tryRemove(word);
+                    }
+                    else {
+                        tree.tryInsert(word);
+                    }
+                    ++recovered.replayedRecords;
+                    position += recordHeaderSize + length;
+                }
+                recovered.discardedBytes += data.size() - position;
+            }
+
+            // Removes checkpoints and logs older than the given generation.
+            void removeObsolete(std::uint64_t base) {
+                bool removed = false;
+                for (const auto& entry : fs::directory_iterator(directory)) {
+                    std::string name = entry.path().filename().string();
+                    std::uint64_t found;
+                    if ((parseGeneration(name, "checkpoint-", ".rdx", found) || parseGeneration(name, "log-", ".wal", found)) && found < base) {
+                        fs::remove(entry.path());
+                        removed = true;
+                    }
+                }
+                if (removed) {
+                    syncDirectory(directory);
+                }
+            }
+
+            /**
+             * @brief Appends a change to the log. Has to be called with the write mutex held, before the change is made to the tree.
+             * @return Number of the record, which is durable once that many records are.
+             */
+            std::uint64_t append(bool removal, std::string_view word) {
+                if (word.size() >= removalFlag) {
+                    throw MyException("The word is too long to be logged");
+                }
+                std::uint32_t lengthField = static_cast<std::uint32_t>(word.size()) | (removal ? removalFlag : 0);
+                std::uint32_t recordChecksum = checksum(lengthField, word);
+
+                std::lock_guard<std::mutex> lock(logMutex);
+                if (!failure.empty()) {
+                    throw MyException(failure);
+                }
+                char header[recordHeaderSize];
+                std::memcpy(header, &recordChecksum, sizeof(recordChecksum));
+                std::memcpy(header + sizeof(recordChecksum), &lengthField, sizeof(lengthField));
+                pending.append(header, sizeof(header));
+                pending.append(word.data(), word.size());
+                logBytes += sizeof(header) + word.size();
+                if (options.checkpointBytes > 0 && logBytes >= options.checkpointBytes && !checkpointRequested) {
+                    checkpointRequested = true;
+                    backgroundWork.notify_all();
+                }
+                return ++appended;
+            }
+
+            /**
+             * @brief Writes and syncs every appended record.
+             * One thread flushes at a time, without the log mutex while it waits for the disk. Records appended meanwhile
+             * wait for the next flush, which commits all of them together.
+             */
+            void flush(std::unique_lock<std::mutex>& lock) {
+                while (flushing) {
+                    logSynced.wait(lock);
+                }
+                if (!failure.empty()) {
+                    throw MyException(failure);
+                }
+                if (durable == appended) {
+                    return;
+                }
+
+                flushing = true;
+                std::string batch;
+                batch.swap(pending);
+                std::uint64_t upTo = appended;
+                int fd = logFd; // rotate waits for the flush to end before replacing it.
+                lock.unlock();
+                std::string error;
+                try {
+                    writeAll(fd, batch.data(), batch.size());
+                    syncFile(fd);
+                }
+                catch (const MyException& exception) {
+                    error = exception.what();
+                }
+                lock.lock();
+                flushing = false;
+                if (error.empty()) {
+                    durable = upTo;
+                }
+                else {
+                    failure = error;
+                }
+                logSynced.notify_all();
+                if (!error.empty()) {
+                    throw MyException(error);
+                }
+            }
+
+            // Waits until the given record is durable, flushing it unless another writer already is.
+            void waitDurable(std::uint64_t record) {
+                std::unique_lock<std::mutex> lock(logMutex);
+                while (durable < record) {
+                    if (flushing) {
+                        logSynced.wait(lock);
+                    }
+                    else {
+                        flush(lock);
+                    }
+                }
+            }
+
+            /**
+             * @brief Syncs the current log and starts the next generation's. Has to be called with the write mutex held.
+             * @return The new generation.
+             */
+            std::uint64_t rotate() {
+                std::unique_lock<std::mutex> lock(logMutex);
+                flush(lock);
+                int nextFd = createLog(generation + 1);
+                closeFile(logFd);
+                logFd = nextFd;
+                logBytes = 0;
+                return ++generation;
+            }
+
+            /**
+             * @brief Saves a snapshot as the checkpoint of a new log generation, then drops the older files.
+             * Only switching logs and taking the snapshot hold up writers; the snapshot is written while they go on.
+             */
+            void checkpoint() {
+                std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+                std::uint64_t covered;
+                ConcurrentRadixTree::Snapshot snapshot = [&] {
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    covered = rotate();
+                    return tree.snapshot();
+                }();
+
+                // Written under a temporary name and renamed once synced, so a crash never leaves a partial checkpoint.
+                fs::path temporary = directory / fileName("checkpoint-", covered, ".rdx.tmp");
+                snapshot.save(temporary.string());
+                syncPath(temporary);
+                fs::rename(temporary, directory / fileName("checkpoint-", covered, ".rdx"));
+                syncDirectory(directory);
+                removeObsolete(covered);
+            }
+
+            void runCheckpoints() {
+                std::unique_lock<std::mutex> lock(logMutex);
+                while (true) {
+                    backgroundWork.wait(lock, [this] {
+                        return stopping || checkpointRequested;
+                    });
+                    if (stopping) {
+                        return;
+                    }
+                    lock.unlock();
+                    try {
+                        checkpoint();
+                    }
+                    catch (...) {
+                        lock.lock();
+                        backgroundFailure = std::current_exception();
+                        lock.unlock();
+                    }
+                    lock.lock();
+                    checkpointRequested = false;
+                }
+            }
+
+            void runFlushes() {
+                std::unique_lock<std::mutex> lock(logMutex);
+                while (!backgroundWork.wait_for(lock, options.flushInterval, [this] { return stopping; })) {
+                    try {
+                        flush(lock);
+                    }
+                    catch (const MyException&) {
+                        // The failure is kept and reported to the next writer.
+                    }
+                }
+            }
+
+            void rethrowBackgroundFailure() {
+                std::exception_ptr stored;
+                {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    std::swap(stored, backgroundFailure);
+                }
+                if (stored) {
+                    std::rethrow_exception(stored);
+                }
+            }
+    };
+
+    DurableRadixTree::DurableRadixTree(const std::string& directory, const Options& options) : pImpl(std::make_unique<DurableImpl>(directory, options)) {
+
+    }
+
+    DurableRadixTree::DurableRadixTree(const std::string& directory) : DurableRadixTree(directory, Options()) {
+
+    }
+
+    DurableRadixTree::~DurableRadixTree() = default;
+
+    void DurableRadixTree::insert(std::string_view word) {
+        if (!tryInsert(word)) {
+            throw MyException("The word already exists in the tree");
+        }
+    }
+
+    bool DurableRadixTree::tryInsert(std::string_view word) {
+        std::uint64_t record;
+        {
+            // The write mutex keeps the word from being added by someone else between the search and the insert.
+            std::lock_guard<std::mutex> lock(pImpl->writeMutex);
+            if (pImpl->tree.search(word)) {
+                return false;
+            }
+            record = pImpl->append(false, word);
+            pImpl->tree.insert(word);
+        }
+        if (pImpl->options.synchronous) {
+            pImpl->waitDurable(record);
+        }
+        return true;
+    }
+
+    void DurableRadixTree::remove(std::string_view word) {
+        if (!tryRemove(word)) {
+            throw MyException("Word not found. Couldn't remove");
+        }
+    }
+
+    bool DurableRadixTree::tryRemove(std::string_view word) {
+        std::uint64_t record;
+        {
+            std::lock_guard<std::mutex> lock(pImpl->writeMutex);
+            if (!pImpl->tree.search(word)) {
+                return false;
+            }
+            record = pImpl->append(true, word);
+            pImpl->tree.remove(word);
+        }
+        if (pImpl->options.synchronous) {
+            pImpl->waitDurable(record);
+        }
+        return true;
+    }
+
+    void DurableRadixTree::sync() {
+        pImpl->rethrowBackgroundFailure();
+        std::unique_lock<std::mutex> lock(pImpl->logMutex);
+        pImpl->flush(lock);
+    }
+
+    void DurableRadixTree::checkpoint() {
+        pImpl->rethrowBackgroundFailure();
+        pImpl->checkpoint();
+    }
+
+    DurableRadixTree::RecoveryStatistics DurableRadixTree::recovery() const {
+        return pImpl->recovered;
+    }
+
+    ConcurrentRadixTree::Snapshot DurableRadixTree::snapshot() const {
+        return pImpl->tree.snapshot();
+    }
+
+    bool DurableRadixTree::search(std::string_view word) const {
+        return pImpl->tree.search(word);
+    }
+
+    bool DurableRadixTree::hasPrefix(std::string_view prefix) const {
+        return pImpl->tree.hasPrefix(prefix);
+    }
+
+    size_t DurableRadixTree::countWithPrefix(std::string_view prefix) const {
+        return pImpl->tree.countWithPrefix(prefix);
+    }
+
+    size_t DurableRadixTree::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        return pImpl->tree.forEachWithPrefix(prefix, callback, limit);
+    }
+
+    size_t DurableRadixTree::size() const {
+        return pImpl->tree.size();
+    }
+
+    bool DurableRadixTree::operator[](std::string_view word) const {
+        return search(word);
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef DURABLE_RADIX_H
+#define DURABLE_RADIX_H
+
+#include "ConcurrentRadixTree.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+namespace RadixTreeProject {
+
+    /**
+     * @class DurableRadixTree
+     * @brief ConcurrentRadixTree whose changes survive a crash, kept in a directory of its own.
+     *
+     * Every insert and remove is appended to a write-ahead log. Writers that arrive while the log is being
+     * synced are committed together by the next sync (group commit). Once the log has grown by
+     * Options::checkpointBytes, a background thread saves a snapshot of the tree as a checkpoint and the log
+     * starts over; readers and writers go on meanwhile, as the snapshot shares the tree's immutable nodes.
+     * Opening the directory loads the newest checkpoint and replays the log written after it.
+     * Implementation of the class is hidden using the PImpl idiom.
+     */
+    class DurableRadixTree {
+        private:
+            class DurableImpl;
+            std::unique_ptr<DurableImpl> pImpl;
+
+        public:
+            using ValueType = RadixTree::ValueType;
+
+            /**
+             * @brief When changes reach the disk and how often checkpoints are taken.
+             */
+            struct Options {
+                bool synchronous = true; // insert and remove return once their change is synced. Otherwise the log is synced every flushInterval.
+                std::chrono::milliseconds flushInterval{10};
+                std::uint64_t checkpointBytes = 64 << 20; // Log bytes after which a checkpoint is taken; 0 to take them only on request.
+            };
+
+            /**
+             * @brief What opening the directory found.
+             */
+            struct RecoveryStatistics {
+                std::uint64_t checkpointWords = 0; // Words loaded from the newest checkpoint.
+                std::uint64_t replayedRecords = 0; // Log records applied on top of it.
+                std::uint64_t discardedBytes = 0; // Torn records at the end of the log, left by a crash before they were synced.
+            };
+
+            /**
+             * @brief Opens the tree kept in a directory, creating the directory if needed, and recovers its contents.
+             * @param directory Directory holding the checkpoints and logs, used by this tree only.
+             * @param options When changes are synced and checkpoints taken.
+             * @throws an exception if the directory can't be used or its newest checkpoint is damaged.
+             */
+            DurableRadixTree(const std::string& directory, const Options& options);
+            explicit DurableRadixTree(const std::string& directory);
+
+            /**
+             * @brief Syncs the changes still waiting for it and stops the background threads.
+             */
+            ~DurableRadixTree();
+
+            DurableRadixTree(const DurableRadixTree&) = delete;
+            DurableRadixTree& operator=(const DurableRadixTree&) = delete;
+
+            /**
+             * @brief Inserts a new word into the tree and logs it.
+             * @param word The word to insert into the tree.
+             * @throws an exception if the word already exists or the log can't be written.
+             */
+            void insert(std::string_view word);
+
+            /**
+             * @brief Inserts a word unless it is already in the tree; nothing is logged for a duplicate.
+             * @return True if the word was added, false if it already existed.
+             * @throws an exception if the log can't be written.
+             */
+            bool tryInsert(std::string_view word);
+
+            /**
+             * @brief Removes a given word from the tree and logs it.
+             * @param word The word to remove from the tree.
+             * @throws an exception if the word doesn't exist in the tree or the log can't be written.
+             */
+            void remove(std::string_view word);
+
+            /**
+             * @brief Removes a word if it is in the tree; nothing is logged for a miss.
+             * @return True if the word was removed, false if it wasn't in the tree.
+             * @throws an exception if the log can't be written.
+             */
+            bool tryRemove(std::string_view word);
+
+            /**
+             * @brief Syncs every change made so far. Only needed without Options::synchronous.
+             * @throws an exception if the log or a background checkpoint couldn't be written.
+             */
+            void sync();
+
+            /**
+             * @brief Takes a checkpoint now and waits for it, so that the next opening has no log to replay.
+             * @throws an exception if the checkpoint can't be written.
+             */
+            void checkpoint();
+
+            /**
+             * @brief Returns what was recovered when the tree was opened.
+             */
+            RecoveryStatistics recovery() const;
+
+            /**
+             * @brief Takes an immutable snapshot of the current contents in O(1) time.
+             */
+            ConcurrentRadixTree::Snapshot snapshot() const;
+
+            /**
+             * @brief Searches for a word in the tree without taking any lock.
+             * Changes are visible as soon as they are made, before they are synced.
+             */
+            bool search(std::string_view word) const;
+
+            /**
+             * @brief Checks whether any word in the tree starts with the given prefix.
+             */
+            bool hasPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Counts the words starting with the given prefix in O(|prefix|) time.
+             */
+            size_t countWithPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Calls the callback for every word starting with the given prefix, in lexicographic order.
+             * @return Number of words reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Returns the number of words stored in the tree.
+             */
+            size_t size() const;
+
+            bool operator[](std::string_view word) const;
+    };
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "FrozenRadixTree.h"
+#include "Succinct.h"
+#include "PrefixMatch.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace RadixTreeProject {
+    class FrozenRadixTree::FrozenImpl {
+        public:
+            // Edges are numbered from 0, so the root, which has no edge, and a missing child get the two largest numbers.
+            static constexpr size_t root = SIZE_MAX;
+            static constexpr size_t missing = SIZE_MAX - 1;
+
+            Succinct::LoudsTree tree;
+
+            explicit FrozenImpl(Succinct::LoudsTree&& layout) : tree(std::move(layout)) {
+
+            }
+
+            /**
+             * @brief Finds the edges of a node's children.
+             * @param edge The edge leading to the node, or root.
+             * @param first Receives the first child's edge.
+             * @param last Receives the edge after the last child's.
+             * @return False if the node has no children.
+             */
+            bool children(size_t edge, size_t& first, size_t& last) const {
+                size_t node = 0;
+                if (edge == root) {
+                    if (tree.edgeCount() == 0) {
+                        return false;
+                    }
+                }
+                else if (!tree.hasChild[edge]) {
+                    return false;
+                }
+                else {
+                    node = tree.hasChild.rank1(edge + 1);
+                }
+                first = tree.louds.select1(node);
+                last = tree.louds.nextOne(first + 1);
+                return true;
+            }
+
+            /**
+             * @brief Finds the child of a node whose label starts with the given character.
+             * @return The child's edge, or missing if there is none.
+             */
+            size_t findChild(size_t edge, unsigned char c) const {
+                size_t first;
+                size_t last;
+                if (!children(edge, first, last)) {
+                    return missing;
+                }
+                const unsigned char* keys = tree.keys.data() + first;
+                size_t count = last - first;
+                if (count <= 16) {
+                    int position = PrefixMatch::findKey16(keys, static_cast<unsigned>(count), c);
+                    return position < 0 ? missing : first + position;
+                }
+                const unsigned char* found = std::lower_bound(keys, keys + count, c);
+                return found == keys + count || *found != c ? missing : first + (found - keys);
+            }
+
+            /**
+             * @brief Finds the part of an edge's label after its key.
+             */
+            std::string_view tail(size_t edge) const {
+                size_t start = tree.tailStarts.select1(edge);
+                size_t end = tree.tailStarts.nextOne(start + 1);
+                return std::string_view(tree.tails.data() + (start - edge), end - start - 1);
+            }
+
+            bool isEndOfWord(size_t edge) const {
+                return edge == root ? tree.rootIsEndOfWord : tree.isEndOfWord[edge];
+            }
+
+            /**
+             * @brief Walks down the tree along the given text.
+             * @param text The text to follow.
+             * @param allowPartial Whether the text may end in the middle of an edge's label.
+             * @param labelStart Receives the position in the text where the found edge's label starts.
+             * @return The edge where the text ends (inside or at the end of its label), root for an empty text,
+             * or missing if the text leaves the tree.
+             */
+            size_t descend(std::string_view text, bool allowPartial, size_t& labelStart) const {
+                size_t edge = root;
+                size_t position = 0;
+                labelStart = 0;
+
+                while (position < text.size()) {
+                    size_t child = findChild(edge, text[position]);
+                    if (child == missing) {
+                        return missing;
+                    }
+
+                    std::string_view rest = tail(child);
+                    size_t available = text.size() - position - 1;
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(rest.data(), text.data() + position + 1, std::min(rest.size(), available));
+                    if (matchingLength != rest.size() && !(allowPartial && matchingLength == available)) {
+                        return missing;
+                    }
+
+                    edge = child;
+                    labelStart = position;
+                    position += 1 + matchingLength;
+                }
+
+                return edge;
+            }
+    };
+
+    FrozenRadixTree::FrozenRadixTree(Succinct::LoudsTree&& layout) : pImpl(std::make_unique<FrozenImpl>(std::move(layout))) {
+
+    }
+
+    FrozenRadixTree::~FrozenRadixTree() = default;
+
+    FrozenRadixTree::FrozenRadixTree(FrozenRadixTree&& other) noexcept = default;
+
+    FrozenRadixTree& FrozenRadixTree::operator=(FrozenRadixTree&& other) noexcept = default;
+
+    std::uint64_t FrozenRadixTree::size() const {
+        return pImpl->tree.wordCount;
+    }
+
+    size_t FrozenRadixTree::memoryUsage() const {
+        return sizeof(FrozenImpl) + pImpl->tree.memoryUsage();
+    }
+
+    bool FrozenRadixTree::search(std::string_view word) const {
+        size_t labelStart;
+        size_t edge = pImpl->descend(word, false, labelStart);
+        return edge != FrozenImpl::missing && pImpl->isEndOfWord(edge);
+    }
+
+    bool FrozenRadixTree::hasPrefix(std::string_view prefix) const {
+        size_t labelStart;
+        return prefix.empty() ? size() > 0 : pImpl->descend(prefix, true, labelStart) != FrozenImpl::missing;
+    }
+
+    size_t FrozenRadixTree::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        size_t labelStart;
+        size_t start = pImpl->descend(prefix, true, labelStart);
+        if (start == FrozenImpl::missing) {
+            return 0;
+        }
+
+        // Same walk as MappedRadixTree: an explicit stack of (edge, buffer length before its label) over one reused buffer.
+        ValueType word(prefix.substr(0, labelStart));
+        std::vector<std::pair<size_t, size_t>> stack;
+        stack.emplace_back(start, word.size());
+        size_t reported = 0;
+
+        while (!stack.empty() && reported < limit) {
+            auto [edge, bufferLength] = stack.back();
+            stack.pop_back();
+
+            word.resize(bufferLength);
+            if (edge != FrozenImpl::root) {
+                word.push_back(static_cast<char>(pImpl->tree.keys[edge]));
+                word.append(pImpl->tail(edge));
+            }
+            if (pImpl->isEndOfWord(edge)) {
+                callback(word);
+                ++reported;
+            }
+
+            size_t first;
+            size_t last;
+            if (pImpl->children(edge, first, last)) {
+                for (size_t child = last; child > first; --child) {
+                    stack.emplace_back(child - 1, word.size());
+                }
+            }
+        }
+
+        return reported;
+    }
+
+    bool FrozenRadixTree::operator[](std::string_view word) const {
+        return search(word);
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef FROZEN_RADIX_H
+#define FROZEN_RADIX_H
+
+#include "RadixTree.h"
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace RadixTreeProject {
+
+    namespace Succinct {
+        struct LoudsTree;
+    }
+
+    /**
+     * @class FrozenRadixTree
+     * @brief Immutable, succinct copy of a RadixTree, made by RadixTree::freeze.
+     *
+     * The shape of the tree is kept in LOUDS bit vectors with rank and select, and the labels
+     * are packed into two byte arrays, so a node costs a few bits besides its label bytes.
+     * Implementation of the class is hidden using the PImpl idiom.
+     */
+    class FrozenRadixTree {
+        private:
+            class FrozenImpl;
+            std::unique_ptr<FrozenImpl> pImpl;
+
+            friend class RadixTree;
+            explicit FrozenRadixTree(Succinct::LoudsTree&& layout);
+
+        public:
+            using ValueType = RadixTree::ValueType;
+
+            ~FrozenRadixTree();
+
+            FrozenRadixTree(const FrozenRadixTree&) = delete;
+            FrozenRadixTree& operator=(const FrozenRadixTree&) = delete;
+
+            FrozenRadixTree(FrozenRadixTree&& other) noexcept;
+            FrozenRadixTree& operator=(FrozenRadixTree&& other) noexcept;
+
+            /**
+             * @brief Returns the number of words in the tree.
+             */
+            std::uint64_t size() const;
+
+            /**
+             * @brief Returns the number of heap bytes the tree uses.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * @brief Searches for a word in the tree.
+             * @param word The word to search in the tree.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool search(std::string_view word) const;
+
+            /**
+             * @brief Checks whether any word in the tree starts with the given prefix.
+             * @param prefix The prefix to look for.
+             * @return True if at least one word starts with the prefix, false otherwise.
+             */
+            bool hasPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Calls the callback for every word starting with the given prefix, in lexicographic order.
+             * An empty prefix iterates over the whole tree.
+             * @param prefix The prefix the words have to start with.
+             * @param callback Function called with each matching word.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Searches for the given word in the tree.
+             * @param word The word to be searched.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool operator[](std::string_view word) const;
+    };
+}
+
+#endif
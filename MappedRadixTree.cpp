@@ -0,0 +1,215 @@
+#include "MappedRadixTree.h"
+#include "RadixFormat.h"
+#include "PrefixMatch.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace RadixTreeProject {
+    class MappedRadixTree::MappedImpl {
+        public:
+            const char* data;
+            size_t length;
+            const RadixFormat::FileHeader* header;
+            const RadixFormat::FileNode* nodes;
+            const unsigned char* keys;
+            const char* labels;
+#ifdef _WIN32
+            std::vector<char> buffer; // Without mmap the file is read into memory once.
+#endif
+
+            /**
+             * @brief Maps the file and checks that it holds a well formed saved tree.
+             */
+            explicit MappedImpl(const std::string& path) : data(nullptr), length(0), header(nullptr), nodes(nullptr), keys(nullptr), labels(nullptr) {
+#ifdef _WIN32
+                std::ifstream file(path, std::ios::binary);
+                if (!file) {
+                    throw MyException("Couldn't open " + path);
+                }
+                buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                data = buffer.data();
+                length = buffer.size();
+#else
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw MyException("Couldn't open " + path);
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+                    ::close(fd);
+                    throw MyException("Couldn't map " + path);
+                }
+                length = static_cast<size_t>(info.st_size);
+                void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (mapping == MAP_FAILED) {
+                    throw MyException("Couldn't map " + path);
+                }
+                data = static_cast<const char*>(mapping);
+#endif
+                if (!validate()) {
+                    unmap();
+                    throw MyException(path + " isn't a saved radix tree");
+                }
+                header = reinterpret_cast<const RadixFormat::FileHeader*>(data);
+                nodes = reinterpret_cast<const RadixFormat::FileNode*>(data + header->nodesOffset);
+                keys = reinterpret_cast<const unsigned char*>(data + header->keysOffset);
+                labels = data + header->labelsOffset;
+            }
+
+            ~MappedImpl() {
+                unmap();
+            }
+
+            void unmap() {
+#ifndef _WIN32
+                if (data) {
+                    ::munmap(const_cast<char*>(data), length);
+                }
+#endif
+                data = nullptr;
+            }
+
+            // Checks every node once, so queries can follow the indexes and offsets in the file without checking them.
+            bool validate() const {
+                return RadixFormat::isValidLayout(data, length);
+            }
+
+            /**
+             * @brief Finds the child of a node whose label starts with the given character.
+             * @return Index of the child, or 0 (the root's index, which is never a child) if there is none.
+             */
+            std::uint32_t findChild(const RadixFormat::FileNode& node, unsigned char c) const {
+                const unsigned char* first = keys + node.firstChild;
+                const unsigned char* last = first + node.childCount;
+                const unsigned char* found = std::lower_bound(first, last, c);
+                if (found == last || *found != c) {
+                    return 0;
+                }
+                return node.firstChild + static_cast<std::uint32_t>(found - first);
+            }
+
+            /**
+             * @brief Walks down the tree along the given text.
+             * @param text The text to follow.
+             * @param allowPartial Whether the text may end in the middle of a node's label.
+             * @param labelStart Receives the position in the text where the returned node's label starts.
+             * @return Index of the node where the text ends (inside or at the end of its label), or 0 if the text leaves the tree.
+             * The root (index 0) is returned for an empty text.
+             */
+            std::uint32_t descend(std::string_view text, bool allowPartial, size_t& labelStart) const {
+                std::uint32_t index = 0;
+                size_t position = 0;
+                labelStart = 0;
+
+                while (position < text.size()) {
+                    std::uint32_t childIndex = findChild(nodes[index], text[position]);
+                    if (childIndex == 0) {
+                        return 0;
+                    }
+
+                    const RadixFormat::FileNode& child = nodes[childIndex];
+                    const char* label = labels + child.labelOffset;
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(label, text.data() + position, std::min<size_t>(child.labelLength, text.size() - position));
+
+                    if (matchingLength != child.labelLength && !(allowPartial && position + matchingLength == text.size())) {
+                        return 0;
+                    }
+
+                    index = childIndex;
+                    labelStart = position;
+                    position += matchingLength;
+                }
+
+                return index;
+            }
+    };
+
+    MappedRadixTree::MappedRadixTree(const std::string& path) : pImpl(std::make_unique<MappedImpl>(path)) {
+
+    }
+
+    MappedRadixTree::~MappedRadixTree() = default;
+
+    MappedRadixTree::MappedRadixTree(MappedRadixTree&& other) noexcept = default;
+
+    MappedRadixTree& MappedRadixTree::operator=(MappedRadixTree&& other) noexcept = default;
+
+    // A moved-from tree has no implementation and answers every query as an empty tree.
+    std::uint64_t MappedRadixTree::size() const {
+        return pImpl ? pImpl->header->wordCount : 0;
+    }
+
+    bool MappedRadixTree::search(std::string_view word) const {
+        if (!pImpl) {
+            return false;
+        }
+        size_t labelStart;
+        std::uint32_t index = pImpl->descend(word, false, labelStart);
+        if (index == 0) {
+            return word.empty() && pImpl->nodes[0].isEndOfWord;
+        }
+        return pImpl->nodes[index].isEndOfWord;
+    }
+
+    bool MappedRadixTree::hasPrefix(std::string_view prefix) const {
+        size_t labelStart;
+        return prefix.empty() ? size() > 0 : pImpl && pImpl->descend(prefix, true, labelStart) != 0;
+    }
+
+    size_t MappedRadixTree::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        if (!pImpl) {
+            return 0;
+        }
+        size_t labelStart;
+        std::uint32_t start = pImpl->descend(prefix, true, labelStart);
+        if (start == 0 && !prefix.empty()) {
+            return 0;
+        }
+
+        /**
+         * Depth-first walk with an explicit stack and a single reused word buffer.
+         * Each entry remembers how long the buffer was before the node's label got appended.
+         * Children are pushed in reverse, so they are visited in ascending order.
+         * The prefix may end in the middle of the first node's label, so the buffer starts at that label's beginning.
+         */
+        ValueType word(prefix.substr(0, labelStart));
+        std::vector<std::pair<std::uint32_t, size_t>> stack;
+        stack.emplace_back(start, word.size());
+        size_t reported = 0;
+
+        while (!stack.empty() && reported < limit) {
+            auto [index, bufferLength] = stack.back();
+            stack.pop_back();
+
+            const RadixFormat::FileNode& node = pImpl->nodes[index];
+            word.resize(bufferLength);
+            word.append(pImpl->labels + node.labelOffset, node.labelLength);
+            if (node.isEndOfWord) {
+                callback(word);
+                ++reported;
+            }
+
+            for (std::uint32_t i = node.childCount; i > 0; --i) {
+                stack.emplace_back(node.firstChild + i - 1, word.size());
+            }
+        }
+
+        return reported;
+    }
+
+    bool MappedRadixTree::operator[](std::string_view word) const {
+        return search(word);
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef MAPPED_RADIX_H
+#define MAPPED_RADIX_H
+
+#include "RadixTree.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace RadixTreeProject {
+
+    /**
+     * @class MappedRadixTree
+     * @brief Read-only radix tree answering queries straight from a file written by RadixTree::save.
+     *
+     * The file is memory-mapped and never deserialized, so opening it is cheap
+     * and processes mapping the same file share one copy of it in the page cache.
+     * Implementation of the class is hidden using the PImpl idiom.
+     */
+    class MappedRadixTree {
+        private:
+            class MappedImpl;
+            std::unique_ptr<MappedImpl> pImpl;
+
+        public:
+            using ValueType = RadixTree::ValueType;
+
+            /**
+             * @brief Maps a saved tree into memory.
+             * @param path Path of the file written by RadixTree::save.
+             * @throws an exception if the file can't be opened or isn't a saved radix tree.
+             */
+            explicit MappedRadixTree(const std::string& path);
+
+            // Destructor - unmaps the file.
+            ~MappedRadixTree();
+
+            MappedRadixTree(const MappedRadixTree&) = delete;
+            MappedRadixTree& operator=(const MappedRadixTree&) = delete;
+
+            /**
+             * @brief Move constructor, takes over the other tree's mapping.
+             * @param other The tree to move from. It is left empty: it holds no words and maps no file.
+             */
+            MappedRadixTree(MappedRadixTree&& other) noexcept;
+
+            /**
+             * @brief Move assignment operator, unmaps this tree's file and takes over the other tree's mapping.
+             * @param other The tree to move from. It is left empty: it holds no words and maps no file.
+             * @return Reference to the current tree.
+             */
+            MappedRadixTree& operator=(MappedRadixTree&& other) noexcept;
+
+            /**
+             * @brief Returns the number of words stored in the file.
+             */
+            std::uint64_t size() const;
+
+            /**
+             * @brief Searches for a word in the tree.
+             * @param word The word to search in the tree.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool search(std::string_view word) const;
+
+            /**
+             * @brief Checks whether any word in the tree starts with the given prefix.
+             * @param prefix The prefix to look for.
+             * @return True if at least one word starts with the prefix, false otherwise.
+             */
+            bool hasPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Calls the callback for every word starting with the given prefix, in lexicographic order.
+             * @param prefix The prefix the words have to start with.
+             * @param callback Function called with each matching word.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Searches for the given word in the tree.
+             * @param word The word to be searched.
+             * @return True if the word exists in the tree, false otherwise.
+             */
+            bool operator[](std::string_view word) const;
+    };
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "PrefixMatch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RADIX_HAS_AVX2_DISPATCH 1
+#endif
+
+namespace RadixTreeProject {
+    namespace PrefixMatch {
+        namespace {
+            using Kernel = size_t (*)(const char*, const char*, size_t);
+
+#ifdef RADIX_HAS_SSE2
+            // Compares 16 bytes per step; the first differing byte is the lowest clear bit of the equality mask.
+            size_t commonPrefixLengthSse2(const char* first, const char* second, size_t length) {
+                size_t matching = 0;
+                while (matching + 16 <= length) {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + matching));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + matching));
+                    unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+                    if (equal != 0xFFFF) {
+                        return matching + __builtin_ctz(~equal);
+                    }
+                    matching += 16;
+                }
+                return matching + commonPrefixLengthScalar(first + matching, second + matching, length - matching);
+            }
+#endif
+
+#ifdef RADIX_HAS_AVX2_DISPATCH
+            // Same as the SSE2 kernel with 32 bytes per step. Only called after checking the CPU supports AVX2.
+            __attribute__((target("avx2")))
+            size_t commonPrefixLengthAvx2(const char* first, const char* second, size_t length) {
+                size_t matching = 0;
+                while (matching + 32 <= length) {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + matching));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + matching));
+                    unsigned equal = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+                    if (equal != 0xFFFFFFFFu) {
+                        return matching + __builtin_ctz(~equal);
+                    }
+                    matching += 32;
+                }
+                return matching + commonPrefixLengthScalar(first + matching, second + matching, length - matching);
+            }
+#endif
+
+            struct Dispatch {
+                Kernel kernel;
+                const char* name;
+            };
+
+            Dispatch selectKernel() {
+#ifdef RADIX_HAS_AVX2_DISPATCH
+                if (__builtin_cpu_supports("avx2")) {
+                    return {commonPrefixLengthAvx2, "avx2"};
+                }
+#endif
+#ifdef RADIX_HAS_SSE2
+                return {commonPrefixLengthSse2, "sse2"};
+#else
+                return {commonPrefixLengthScalar, "scalar"};
+#endif
+            }
+
+            // Chosen once, on first use, so static initialization order doesn't matter.
+            const Dispatch& dispatch() {
+                static const Dispatch selected = selectKernel();
+                return selected;
+            }
+        }
+
+        size_t commonPrefixLengthVector(const char* first, const char* second, size_t length) {
+            return dispatch().kernel(first, second, length);
+        }
+
+        const char* kernelName() {
+            return dispatch().name;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef PREFIX_MATCH_H
+#define PREFIX_MATCH_H
+
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define RADIX_HAS_SSE2 1
+#endif
+
+namespace RadixTreeProject {
+
+    /**
+     * @brief Byte matching kernels shared by every tree walk: edge label comparison and child key lookup.
+     *
+     * Long labels are compared 16 or 32 bytes at a time with SSE2 or AVX2, picked at runtime
+     * from what the CPU supports. Other CPUs use the scalar loop.
+     */
+    namespace PrefixMatch {
+        /**
+         * @brief Byte-by-byte reference implementation, also used for labels too short for vector compares.
+         */
+        inline size_t commonPrefixLengthScalar(const char* first, const char* second, size_t length) {
+            size_t matching = 0;
+            while (matching < length && first[matching] == second[matching]) {
+                ++matching;
+            }
+            return matching;
+        }
+
+        /**
+         * @brief Compares long byte ranges with the widest kernel the CPU supports.
+         */
+        size_t commonPrefixLengthVector(const char* first, const char* second, size_t length);
+
+        /**
+         * @brief Returns the name of the kernel commonPrefixLengthVector dispatches to ("avx2", "sse2" or "scalar").
+         */
+        const char* kernelName();
+
+        /**
+         * @brief Counts how many leading bytes two ranges have in common.
+         * @param first The first range.
+         * @param second The second range.
+         * @param length Number of bytes readable in both ranges.
+         * @return Length of the common prefix, at most length.
+         */
+        inline size_t commonPrefixLength(const char* first, const char* second, size_t length) {
+            // Most labels are short, where a call through the dispatch pointer costs more than it saves.
+            if (length < 16) {
+                return commonPrefixLengthScalar(first, second, length);
+            }
+            return commonPrefixLengthVector(first, second, length);
+        }
+
+        /**
+         * @brief Finds a key in an array of 16 child keys, of which the first count are in use.
+         * @return Position of the key, -1 if it isn't there.
+         */
+        inline int findKey16(const unsigned char* keys, unsigned count, unsigned char key) {
+#ifdef RADIX_HAS_SSE2
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << count) - 1);
+            return mask ? __builtin_ctz(mask) : -1;
+#else
+            for (unsigned i = 0; i < count; ++i) {
+                if (keys[i] == key) {
+                    return static_cast<int>(i);
+                }
+            }
+            return -1;
+#endif
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef RADIX_FORMAT_H
+#define RADIX_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+
+namespace RadixTreeProject {
+
+    /**
+     * @brief Layout of the file written by RadixTree::save and ConcurrentRadixTree::Snapshot::save,
+     * read by MappedRadixTree and ConcurrentRadixTree::load.
+     *
+     * The file holds no pointers, only indexes and offsets relative to the start of the file,
+     * so it can be mapped at any address and queried in place:
+     * [FileHeader][FileNode x nodeCount][child key byte x nodeCount][label bytes]
+     * Nodes are stored in breadth-first order and the children of every node are contiguous,
+     * sorted by the first byte of their label, which is also kept in the separate key array for fast dispatch.
+     * All integers are stored in the byte order of the machine that wrote the file.
+     */
+    namespace RadixFormat {
+        constexpr char magic[8] = {'R', 'A', 'D', 'I', 'X', 'T', 'R', '\0'};
+        constexpr std::uint32_t version = 1;
+        constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrderMark;
+            std::uint64_t nodeCount;
+            std::uint64_t wordCount;
+            std::uint64_t nodesOffset;
+            std::uint64_t keysOffset;
+            std::uint64_t labelsOffset;
+            std::uint64_t labelBytes;
+        };
+
+        struct FileNode {
+            std::uint64_t labelOffset; // Offset of the label inside the label area.
+            std::uint32_t labelLength;
+            std::uint32_t firstChild; // Index of the first child, the rest follow it.
+            std::uint16_t childCount;
+            std::uint8_t isEndOfWord;
+            std::uint8_t reserved[5];
+        };
+
+        static_assert(sizeof(FileHeader) == 64, "FileHeader must not contain padding");
+        static_assert(sizeof(FileNode) == 24, "FileNode must not contain padding");
+
+        /**
+         * @brief Writes a file under a temporary name and renames it over the path once it is complete.
+         * Processes that have the old file mapped keep reading it unchanged, instead of seeing it rewritten in place.
+         * @param path Path of the file to replace.
+         * @param write Function writing the contents to the stream it is given.
+         * @return True if the file was replaced, false if it couldn't be written; the old file is kept then.
+         */
+        template <typename Write>
+        bool replaceFile(const std::string& path, Write&& write) {
+            std::string temporary = path + ".tmp";
+            bool written;
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                if (!file) {
+                    return false;
+                }
+                write(file);
+                written = static_cast<bool>(file.flush());
+            }
+            std::error_code error;
+            if (written) {
+                std::filesystem::rename(temporary, path, error);
+            }
+            if (!written || error) {
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+            return true;
+        }
+
+        // Checks the header against the file size, so the node, key and label areas lie inside the file.
+        inline bool isValidHeader(const char* data, size_t length) {
+            if (length < sizeof(FileHeader)) {
+                return false;
+            }
+            FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            // Children are indexed with 32 bits, which also keeps the offsets below from overflowing.
+            return std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+                   header.version == version &&
+                   header.byteOrderMark == byteOrderMark &&
+                   header.nodeCount > 0 && header.nodeCount <= UINT32_MAX &&
+                   header.nodesOffset == sizeof(FileHeader) &&
+                   header.keysOffset == header.nodesOffset + header.nodeCount * sizeof(FileNode) &&
+                   header.labelsOffset == header.keysOffset + header.nodeCount &&
+                   header.labelsOffset <= length &&
+                   header.labelBytes == length - header.labelsOffset;
+        }
+
+        /**
+         * @brief Checks a whole saved tree, so that walking it never leaves the file or loops.
+         * Besides the header, every node's label has to lie inside the label area, and every node's children have to
+         * come after it and right after those of the node before it, so each node but the root has exactly one parent.
+         * Labels of all nodes but the root have to be non-empty and keyed by their first byte, in ascending order.
+         * Takes time proportional to the number of nodes.
+         */
+        inline bool isValidLayout(const char* data, size_t length) {
+            if (!isValidHeader(data, length)) {
+                return false;
+            }
+            FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            const unsigned char* keys = reinterpret_cast<const unsigned char*>(data + header.keysOffset);
+            const char* labels = data + header.labelsOffset;
+
+            std::uint64_t expectedChild = 1;
+            for (std::uint64_t i = 0; i < header.nodeCount; ++i) {
+                FileNode node;
+                std::memcpy(&node, data + header.nodesOffset + i * sizeof(FileNode), sizeof(node));
+                if (node.labelLength > header.labelBytes || node.labelOffset > header.labelBytes - node.labelLength) {
+                    return false;
+                }
+                if (i == 0 ? node.labelLength != 0 : node.labelLength == 0 || keys[i] != static_cast<unsigned char>(labels[node.labelOffset])) {
+                    return false;
+                }
+                if (node.childCount > 0) {
+                    if (node.firstChild != expectedChild || node.firstChild <= i || expectedChild + node.childCount > header.nodeCount) {
+                        return false;
+                    }
+                    for (std::uint64_t j = node.firstChild + 1; j < expectedChild + node.childCount; ++j) {
+                        if (keys[j - 1] >= keys[j]) {
+                            return false;
+                        }
+                    }
+                }
+                expectedChild += node.childCount;
+            }
+            return expectedChild == header.nodeCount;
+        }
+    }
+}
+
+#endif
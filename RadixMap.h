@@ -0,0 +1,522 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef RADIX_MAP_H
+#define RADIX_MAP_H
+
+#include "RadixTree.h"
+#include "PrefixMatch.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <cstdint>
+
+namespace RadixTreeProject {
+
+    namespace RadixMapDetail {
+        // Values small and trivial enough to be copied around freely are kept inside the node itself.
+        template <typename Value>
+        constexpr bool storedInline = std::is_trivially_copyable<Value>::value && sizeof(Value) <= 2 * sizeof(void*);
+
+        /**
+         * @brief Storage for the value of a terminal node. Whether the slot holds a value is tracked by the node.
+         */
+        template <typename Value, typename Alloc, bool Inline = storedInline<Value>>
+        class ValueSlot {
+            private:
+                alignas(Value) unsigned char storage[sizeof(Value)];
+
+            public:
+                Value* get() {
+                    return std::launder(reinterpret_cast<Value*>(storage));
+                }
+
+                const Value* get() const {
+                    return std::launder(reinterpret_cast<const Value*>(storage));
+                }
+
+                template <typename... Args>
+                void emplace(Alloc&, Args&&... args) {
+                    ::new (static_cast<void*>(storage)) Value(std::forward<Args>(args)...);
+                }
+
+                // Trivially copyable values have nothing to destroy.
+                void destroy(Alloc&) {
+
+                }
+        };
+
+        // Larger values are allocated separately, so nodes without a value don't pay for their size.
+        template <typename Value, typename Alloc>
+        class ValueSlot<Value, Alloc, false> {
+            private:
+                using Traits = std::allocator_traits<Alloc>;
+
+                Value* value = nullptr;
+
+            public:
+                Value* get() {
+                    return value;
+                }
+
+                const Value* get() const {
+                    return value;
+                }
+
+                template <typename... Args>
+                void emplace(Alloc& allocator, Args&&... args) {
+                    Value* created = Traits::allocate(allocator, 1);
+                    try {
+                        Traits::construct(allocator, created, std::forward<Args>(args)...);
+                    }
+                    catch (...) {
+                        Traits::deallocate(allocator, created, 1);
+                        throw;
+                    }
+                    value = created;
+                }
+
+                void destroy(Alloc& allocator) {
+                    Traits::destroy(allocator, value);
+                    Traits::deallocate(allocator, value, 1);
+                    value = nullptr;
+                }
+        };
+    }
+
+    /**
+     * @class RadixMap
+     * @brief Radix tree mapping byte string keys to values stored in the terminal nodes.
+     *
+     * Keys are only stored once, split along the tree's edges, instead of being duplicated
+     * in a separate hash map next to a RadixTree. Small trivially copyable values live inside
+     * the node, larger ones are allocated once per key with the given allocator.
+     * Lookups take std::string_view, so keys held in other buffers don't have to be copied.
+     * @tparam Key String type the keys are reported as. Its characters must be char.
+     * @tparam Value Type of the mapped values.
+     * @tparam Alloc Allocator for the values, rebound for nodes and labels.
+     */
+    template <typename Key, typename Value, typename Alloc = std::allocator<Value>>
+    class RadixMap {
+        static_assert(std::is_same<typename Key::value_type, char>::value, "RadixMap keys must be strings of char");
+
+        public:
+            using key_type = Key;
+            using mapped_type = Value;
+            using allocator_type = Alloc;
+
+            // Whether values are stored inside the nodes rather than allocated separately.
+            static constexpr bool storesValuesInline = RadixMapDetail::storedInline<Value>;
+
+        private:
+            struct Node;
+
+            using AllocTraits = std::allocator_traits<Alloc>;
+            using ValueAllocator = typename AllocTraits::template rebind_alloc<Value>;
+            using NodeAllocator = typename AllocTraits::template rebind_alloc<Node>;
+            using NodeTraits = std::allocator_traits<NodeAllocator>;
+            using Label = std::basic_string<char, std::char_traits<char>, typename AllocTraits::template rebind_alloc<char>>;
+            using KeyVector = std::vector<unsigned char, typename AllocTraits::template rebind_alloc<unsigned char>>;
+            using ChildVector = std::vector<Node*, typename AllocTraits::template rebind_alloc<Node*>>;
+
+            /**
+             * @brief Node of the map. Children are kept sorted by the first byte of their label.
+             */
+            struct Node {
+                Label label;
+                KeyVector keys;
+                ChildVector children;
+                bool hasValue;
+                RadixMapDetail::ValueSlot<Value, ValueAllocator> slot;
+
+                Node(const char* data, size_t length, const Alloc& allocator) : label(data, length, allocator), keys(allocator), children(allocator), hasValue(false) {
+
+                }
+            };
+
+            Alloc allocator;
+            ValueAllocator valueAllocator;
+            NodeAllocator nodeAllocator;
+            Node* root; // Created with the first key, so empty and moved-from maps own no memory.
+            size_t count;
+
+            Node* createNode(const char* data, size_t length) {
+                Node* node = NodeTraits::allocate(nodeAllocator, 1);
+                try {
+                    NodeTraits::construct(nodeAllocator, node, data, length, allocator);
+                }
+                catch (...) {
+                    NodeTraits::deallocate(nodeAllocator, node, 1);
+                    throw;
+                }
+                return node;
+            }
+
+            // Frees a single node and its value. Its children have to be detached or destroyed already.
+            void destroyNode(Node* node) {
+                if (node->hasValue) {
+                    node->slot.destroy(valueAllocator);
+                }
+                NodeTraits::destroy(nodeAllocator, node);
+                NodeTraits::deallocate(nodeAllocator, node, 1);
+            }
+
+            void destroySubtree(Node* node) {
+                for (Node* child : node->children) {
+                    destroySubtree(child);
+                }
+                destroyNode(node);
+            }
+
+            Node* copySubtree(const Node* node) {
+                Node* copy = createNode(node->label.data(), node->label.size());
+                try {
+                    if (node->hasValue) {
+                        copy->slot.emplace(valueAllocator, *node->slot.get());
+                        copy->hasValue = true;
+                    }
+                    // Reserved up front, so adding a copied child can't throw and leak it.
+                    copy->keys.reserve(node->keys.size());
+                    copy->children.reserve(node->children.size());
+                    for (const Node* child : node->children) {
+                        copy->children.push_back(copySubtree(child));
+                        copy->keys.push_back(child->label[0]);
+                    }
+                }
+                catch (...) {
+                    destroySubtree(copy);
+                    throw;
+                }
+                return copy;
+            }
+
+            // Returns the position of the child whose label starts with the key, children.size() if there is none.
+            static size_t findChild(const Node* node, unsigned char key) {
+                auto found = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+                return found != node->keys.end() && *found == key ? found - node->keys.begin() : node->children.size();
+            }
+
+            static void addChild(Node* node, Node* child) {
+                unsigned char key = child->label[0];
+                size_t position = std::lower_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+                node->keys.insert(node->keys.begin() + position, key);
+                node->children.insert(node->children.begin() + position, child);
+            }
+
+            /**
+             * @brief Walks down the map along the given text.
+             * @param allowPartial Whether the text may end in the middle of a node's label.
+             * @param labelStart Receives the position in the text where the returned node's label starts.
+             * @return The node where the text ends, nullptr if the text leaves the map.
+             */
+            Node* descend(std::string_view text, bool allowPartial, size_t& labelStart) const {
+                labelStart = 0;
+                if (!root) {
+                    return nullptr;
+                }
+
+                Node* node = root;
+                size_t index = 0;
+                while (index < text.size()) {
+                    size_t position = findChild(node, text[index]);
+                    if (position == node->children.size()) {
+                        return nullptr;
+                    }
+
+                    Node* child = node->children[position];
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->label.data(), text.data() + index, std::min(child->label.size(), text.size() - index));
+                    if (matchingLength != child->label.size() && !(allowPartial && index + matchingLength == text.size())) {
+                        return nullptr;
+                    }
+
+                    node = child;
+                    labelStart = index;
+                    index += matchingLength;
+                }
+                return node;
+            }
+
+            // Replaces a valueless node that has a single child by that child, keeping the path compressed.
+            void joinWithChild(Node* parent, size_t position) {
+                Node* node = parent->children[position];
+                Node* child = node->children[0];
+                child->label.insert(0, node->label);
+                parent->children[position] = child;
+                node->children.clear();
+                destroyNode(node);
+            }
+
+        public:
+            explicit RadixMap(const Alloc& alloc = Alloc()) : allocator(alloc), valueAllocator(alloc), nodeAllocator(alloc), root(nullptr), count(0) {
+
+            }
+
+            RadixMap(const RadixMap& other) : RadixMap(AllocTraits::select_on_container_copy_construction(other.allocator)) {
+                root = other.root ? copySubtree(other.root) : nullptr;
+                count = other.count;
+            }
+
+            RadixMap(RadixMap&& other) noexcept : allocator(std::move(other.allocator)), valueAllocator(allocator), nodeAllocator(allocator), root(other.root), count(other.count) {
+                other.root = nullptr;
+                other.count = 0;
+            }
+
+            RadixMap& operator=(RadixMap other) noexcept {
+                swap(other);
+                return *this;
+            }
+
+            ~RadixMap() {
+                clear();
+            }
+
+            void swap(RadixMap& other) noexcept {
+                using std::swap;
+                swap(allocator, other.allocator);
+                swap(valueAllocator, other.valueAllocator);
+                swap(nodeAllocator, other.nodeAllocator);
+                swap(root, other.root);
+                swap(count, other.count);
+            }
+
+            size_t size() const {
+                return count;
+            }
+
+            bool empty() const {
+                return count == 0;
+            }
+
+            // Removes every key and frees all nodes.
+            void clear() {
+                if (root) {
+                    destroySubtree(root);
+                    root = nullptr;
+                }
+                count = 0;
+            }
+
+            /**
+             * @brief Finds the value stored under a key.
+             * @param key The key to look up.
+             * @return Pointer to the value, nullptr if the key isn't in the map.
+             * The pointer stays valid until the key is erased, even if other keys are added or removed.
+             */
+            Value* find(std::string_view key) {
+                size_t labelStart;
+                Node* node = descend(key, false, labelStart);
+                return node && node->hasValue ? node->slot.get() : nullptr;
+            }
+
+            const Value* find(std::string_view key) const {
+                return const_cast<RadixMap*>(this)->find(key);
+            }
+
+            bool contains(std::string_view key) const {
+                return find(key) != nullptr;
+            }
+
+            /**
+             * @brief Returns the value stored under a key.
+             * @throws an exception if the key isn't in the map.
+             */
+            Value& at(std::string_view key) {
+                Value* value = find(key);
+                if (!value) {
+                    throw MyException("Key not found");
+                }
+                return *value;
+            }
+
+            const Value& at(std::string_view key) const {
+                return const_cast<RadixMap*>(this)->at(key);
+            }
+
+            /**
+             * @brief Constructs a value under the key unless the key is already present.
+             * @param key The key to add.
+             * @param args Arguments for the value's constructor, unused if the key exists.
+             * @return Pointer to the value under the key and whether it was inserted.
+             */
+            template <typename... Args>
+            std::pair<Value*, bool> try_emplace(std::string_view key, Args&&... args) {
+                if (!root) {
+                    root = createNode("", 0);
+                }
+
+                Node* node = root;
+                size_t index = 0;
+                while (index < key.size()) {
+                    size_t position = findChild(node, key[index]);
+                    if (position == node->children.size()) {
+                        Node* leaf = createNode(key.data() + index, key.size() - index);
+                        try {
+                            leaf->slot.emplace(valueAllocator, std::forward<Args>(args)...);
+                        }
+                        catch (...) {
+                            destroyNode(leaf);
+                            throw;
+                        }
+                        leaf->hasValue = true;
+                        addChild(node, leaf);
+                        ++count;
+                        return {leaf->slot.get(), true};
+                    }
+
+                    Node* child = node->children[position];
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->label.data(), key.data() + index, std::min(child->label.size(), key.size() - index));
+                    // The key ends or branches off inside the child's label, so the child is split there.
+                    if (matchingLength != child->label.size()) {
+                        Node* upper = createNode(child->label.data(), matchingLength);
+                        child->label.erase(0, matchingLength);
+                        upper->keys.push_back(child->label[0]);
+                        upper->children.push_back(child);
+                        node->children[position] = upper;
+                        child = upper;
+                    }
+
+                    node = child;
+                    index += matchingLength;
+                }
+
+                if (node->hasValue) {
+                    return {node->slot.get(), false};
+                }
+                node->slot.emplace(valueAllocator, std::forward<Args>(args)...);
+                node->hasValue = true;
+                ++count;
+                return {node->slot.get(), true};
+            }
+
+            /**
+             * @brief Stores a value under the key, replacing the current one if the key is present.
+             * @return Pointer to the value under the key and whether the key was newly inserted.
+             */
+            template <typename V>
+            std::pair<Value*, bool> insert_or_assign(std::string_view key, V&& value) {
+                std::pair<Value*, bool> result = try_emplace(key, std::forward<V>(value));
+                if (!result.second) {
+                    *result.first = std::forward<V>(value);
+                }
+                return result;
+            }
+
+            /**
+             * @brief Returns the value under the key, inserting a default constructed one if the key is missing.
+             */
+            Value& operator[](std::string_view key) {
+                return *try_emplace(key).first;
+            }
+
+            /**
+             * @brief Removes a key and its value.
+             * Nodes left without keys are freed and pass-through nodes are joined with their only child.
+             * @return Number of removed keys (0 or 1).
+             */
+            size_t erase(std::string_view key) {
+                if (!root) {
+                    return 0;
+                }
+
+                // Every node on the path, with the position of the next one among its children.
+                std::vector<std::pair<Node*, size_t>> path;
+                Node* node = root;
+                size_t index = 0;
+                while (index < key.size()) {
+                    size_t position = findChild(node, key[index]);
+                    if (position == node->children.size()) {
+                        return 0;
+                    }
+
+                    Node* child = node->children[position];
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->label.data(), key.data() + index, std::min(child->label.size(), key.size() - index));
+                    if (matchingLength != child->label.size()) {
+                        return 0;
+                    }
+
+                    path.emplace_back(node, position);
+                    node = child;
+                    index += matchingLength;
+                }
+
+                if (!node->hasValue) {
+                    return 0;
+                }
+                node->slot.destroy(valueAllocator);
+                node->hasValue = false;
+                --count;
+
+                if (path.empty()) {
+                    return 1;
+                }
+
+                auto [parent, position] = path.back();
+                if (node->children.size() == 1) {
+                    joinWithChild(parent, position);
+                }
+                else if (node->children.empty()) {
+                    parent->keys.erase(parent->keys.begin() + position);
+                    parent->children.erase(parent->children.begin() + position);
+                    destroyNode(node);
+                    // The parent may now be a pass-through node itself.
+                    if (path.size() > 1 && !parent->hasValue && parent->children.size() == 1) {
+                        joinWithChild(path[path.size() - 2].first, path[path.size() - 2].second);
+                    }
+                }
+                return 1;
+            }
+
+            /**
+             * @brief Calls the callback for every key starting with the given prefix and its value, in lexicographic order.
+             * The callback must not modify the map.
+             * @param prefix The prefix the keys have to start with.
+             * @param callback Function called with each matching key and its value.
+             * @param limit Maximum number of keys to report.
+             * @return Number of keys reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const Key&, const Value&)>& callback, size_t limit = SIZE_MAX) const {
+                size_t labelStart;
+                const Node* start = descend(prefix, true, labelStart);
+                if (!start) {
+                    return 0;
+                }
+
+                // Depth-first walk with an explicit stack and a single reused key buffer, as in MappedRadixTree.
+                Key key(prefix.substr(0, labelStart));
+                std::vector<std::pair<const Node*, size_t>> stack;
+                stack.emplace_back(start, key.size());
+                size_t reported = 0;
+                while (!stack.empty() && reported < limit) {
+                    auto [node, bufferLength] = stack.back();
+                    stack.pop_back();
+
+                    key.resize(bufferLength);
+                    key.append(node->label.data(), node->label.size());
+                    if (node->hasValue) {
+                        callback(key, *node->slot.get());
+                        ++reported;
+                    }
+                    for (size_t i = node->children.size(); i > 0; --i) {
+                        stack.emplace_back(node->children[i - 1], key.size());
+                    }
+                }
+                return reported;
+            }
+
+            /**
+             * @brief Calls the callback for every key and its value, in lexicographic order.
+             */
+            size_t forEach(const std::function<void(const Key&, const Value&)>& callback) const {
+                return forEachWithPrefix(std::string_view(), callback);
+            }
+    };
+}
+
+#endif
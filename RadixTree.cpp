@@ -1,222 +1,2546 @@
 #include "RadixTree.h"
+#include "RadixFormat.h"
+#include "PrefixMatch.h"
+#include "FrozenRadixTree.h"
+#include "Succinct.h"
 #include <iostream>
 #include <string>
-#include <unordered_map>
 #include <sstream>
+#include <fstream>
+#include <cstring>
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <new>
+#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <exception>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef RADIX_TREE_STATS
+#include <chrono>
+#endif
 
 namespace RadixTreeProject {
+    namespace {
+        // Thread count set by RadixTree::setThreadCount, 0 while the hardware's is used.
+        std::atomic<size_t> configuredThreads(0);
+    }
+
+#ifdef RADIX_TREE_STATS
+    namespace {
+        using OperationStatistics = RadixTree::OperationStatistics;
+
+        /**
+         * @brief One thread's operation counters. Only the owning thread writes them,
+         * so plain relaxed loads and stores are enough, and readers never see torn values.
+         */
+        struct ThreadCounters {
+            std::atomic<std::uint64_t> calls[OperationStatistics::operationCount];
+            std::atomic<std::uint64_t> buckets[OperationStatistics::operationCount][OperationStatistics::bucketCount];
+
+            ThreadCounters();
+            ~ThreadCounters();
+
+            static void increment(std::atomic<std::uint64_t>& counter) {
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            void addTo(OperationStatistics& statistics) const {
+                for (size_t operation = 0; operation < OperationStatistics::operationCount; ++operation) {
+                    statistics.calls[operation] += calls[operation].load(std::memory_order_relaxed);
+                    for (size_t bucket = 0; bucket < OperationStatistics::bucketCount; ++bucket) {
+                        statistics.latencyHistogram[operation][bucket] += buckets[operation][bucket].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        // The counters of running threads, and the totals of threads that have exited.
+        struct CounterRegistry {
+            std::mutex mutex;
+            std::vector<const ThreadCounters*> live;
+            OperationStatistics retired;
+        };
+
+        // Never destroyed, since threads may still exit after static destruction has begun.
+        CounterRegistry& registry() {
+            static CounterRegistry* counters = new CounterRegistry();
+            return *counters;
+        }
+
+        ThreadCounters::ThreadCounters() : calls(), buckets() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().live.push_back(this);
+        }
+
+        ThreadCounters::~ThreadCounters() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            addTo(registry().retired);
+            auto& live = registry().live;
+            live.erase(std::find(live.begin(), live.end(), this));
+        }
+
+        ThreadCounters& threadCounters() {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        /**
+         * @brief Counts an operation, and times it if it is the thread's turn to take a sample.
+         */
+        class OperationTimer {
+            private:
+                ThreadCounters& counters;
+                OperationStatistics::Operation operation;
+                bool sampled;
+                std::chrono::steady_clock::time_point start;
+
+            public:
+                explicit OperationTimer(OperationStatistics::Operation operation) : counters(threadCounters()), operation(operation) {
+                    std::uint64_t calls = counters.calls[operation].load(std::memory_order_relaxed);
+                    counters.calls[operation].store(calls + 1, std::memory_order_relaxed);
+                    sampled = calls % OperationStatistics::sampleInterval == 0;
+                    if (sampled) {
+                        start = std::chrono::steady_clock::now();
+                    }
+                }
+
+                ~OperationTimer() {
+                    if (!sampled) {
+                        return;
+                    }
+                    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    size_t bucket = elapsed > 1 ? 63 - __builtin_clzll(static_cast<std::uint64_t>(elapsed)) : 0;
+                    ThreadCounters::increment(counters.buckets[operation][std::min(bucket, OperationStatistics::bucketCount - 1)]);
+                }
+        };
+    }
+
+// Hook for the hot paths; without RADIX_TREE_STATS it compiles to nothing.
+#define RADIX_STATS_TIME(operation) OperationTimer operationTimer(OperationStatistics::operation)
+#else
+#define RADIX_STATS_TIME(operation)
+#endif
+
     class RadixTree::RadixImpl{
         public:
+            struct RadixNode;
+
+            // Hints the CPU to start loading the cache lines of an object that will be read soon.
+            static void prefetch(const void* address, size_t size = 1) {
+#if defined(__GNUC__) || defined(__clang__)
+                for (size_t offset = 0; offset < size; offset += 64) {
+                    __builtin_prefetch(static_cast<const char*>(address) + offset);
+                }
+#else
+                (void)address;
+                (void)size;
+#endif
+            }
+
+            /**
+             * @brief Supplies the memory for nodes, child tables and labels of one tree.
+             *
+             * In heap mode every request goes straight to operator new/delete.
+             * In arena mode memory is carved out of large slabs owned by the tree. Released blocks are kept
+             * on per-size free lists for reuse, and the whole tree is freed at once by dropping the slabs.
+             */
+            class NodePool {
+                private:
+                    static constexpr size_t slabSize = 64 * 1024;
+                    static constexpr size_t granularity = 8;
+                    static constexpr size_t largestClass = 2048;
+
+                    struct FreeBlock {
+                        FreeBlock* next;
+                    };
+
+                    bool arena;
+                    std::vector<std::unique_ptr<char[]>> slabs;
+                    char* cursor;
+                    size_t remaining;
+                    FreeBlock* freeLists[largestClass / granularity + 1];
+
+                    static size_t roundUp(size_t size) {
+                        return (size + granularity - 1) / granularity * granularity;
+                    }
+
+                public:
+                    explicit NodePool(bool useArena) : arena(useArena), cursor(nullptr), remaining(0), freeLists() {
+
+                    }
+
+                    NodePool(const NodePool&) = delete;
+                    NodePool& operator=(const NodePool&) = delete;
+
+                    bool isArena() const {
+                        return arena;
+                    }
+
+                    size_t slabCount() const {
+                        return slabs.size();
+                    }
+
+                    void* allocate(size_t size) {
+                        if (!arena) {
+                            return ::operator new(size);
+                        }
+
+                        size = roundUp(size);
+                        // Blocks too large for a size class get a dedicated slab of their own.
+                        if (size > largestClass) {
+                            slabs.push_back(std::make_unique<char[]>(size));
+                            return slabs.back().get();
+                        }
+
+                        FreeBlock*& freeList = freeLists[size / granularity];
+                        if (freeList) {
+                            FreeBlock* block = freeList;
+                            freeList = block->next;
+                            return block;
+                        }
+
+                        if (remaining < size) {
+                            slabs.push_back(std::make_unique<char[]>(slabSize));
+                            cursor = slabs.back().get();
+                            remaining = slabSize;
+                        }
+                        void* block = cursor;
+                        cursor += size;
+                        remaining -= size;
+                        return block;
+                    }
+
+                    void deallocate(void* ptr, size_t size) noexcept {
+                        if (!arena) {
+                            ::operator delete(ptr);
+                            return;
+                        }
+
+                        size = roundUp(size);
+                        // Dedicated slabs stay alive until the whole arena is released.
+                        if (size > largestClass) {
+                            return;
+                        }
+
+                        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+                        block->next = freeLists[size / granularity];
+                        freeLists[size / granularity] = block;
+                    }
+
+                    // Frees every slab at once, invalidating all memory handed out by the arena.
+                    void release() {
+                        slabs.clear();
+                        cursor = nullptr;
+                        remaining = 0;
+                        std::fill(std::begin(freeLists), std::end(freeLists), nullptr);
+                    }
+            };
+
+            /**
+             * @brief Standard allocator adaptor that takes label bytes from the tree's NodePool.
+             * Heap-mode trees pass no pool, so their labels don't depend on the tree they were created in
+             * and whole subtrees can be moved between heap-mode trees.
+             */
+            template <typename T>
+            struct PoolAllocator {
+                using value_type = T;
+
+                NodePool* pool;
+
+                explicit PoolAllocator(NodePool* nodePool) noexcept : pool(nodePool) {
+
+                }
+
+                template <typename U>
+                PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {
+
+                }
+
+                T* allocate(size_t n) {
+                    if (!pool) {
+                        return static_cast<T*>(::operator new(n * sizeof(T)));
+                    }
+                    return static_cast<T*>(pool->allocate(n * sizeof(T)));
+                }
+
+                void deallocate(T* ptr, size_t n) noexcept {
+                    if (!pool) {
+                        ::operator delete(ptr);
+                        return;
+                    }
+                    pool->deallocate(ptr, n * sizeof(T));
+                }
+
+                friend bool operator==(const PoolAllocator& a, const PoolAllocator& b) {
+                    return a.pool == b.pool;
+                }
+
+                friend bool operator!=(const PoolAllocator& a, const PoolAllocator& b) {
+                    return a.pool != b.pool;
+                }
+            };
+
+            // Edge label type. Short labels stay inside the node, longer ones live in the tree's pool.
+            using Label = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+            /**
+             * @brief Adaptive container for a node's children, laid out like the nodes of an Adaptive Radix Tree.
+             *
+             * Up to 4 children are stored inline in the node (Node4). As the fan-out grows the table moves
+             * to a separately allocated Node16 (sorted key array), Node48 (byte index into 48 slots)
+             * and finally Node256 (direct array), and shrinks back when children are erased.
+             * Keys are always kept in ascending order, so iteration visits children lexicographically.
+             */
+            class ChildTable {
+                private:
+                    enum class Kind : unsigned char { Node4, Node16, Node48, Node256 };
+
+                    struct Node16 {
+                        unsigned char keys[16];
+                        RadixNode* children[16];
+                    };
+
+                    struct Node48 {
+                        unsigned char index[256]; // 0 marks an empty key, otherwise slot number + 1.
+                        RadixNode* children[48];
+                    };
+
+                    struct Node256 {
+                        RadixNode* children[256];
+                    };
+
+                    struct Node4 {
+                        unsigned char keys[4];
+                        RadixNode* children[4];
+                    };
+
+                    Kind kind;
+                    unsigned short count;
+                    union {
+                        Node4 n4;
+                        Node16* n16;
+                        Node48* n48;
+                        Node256* n256;
+                    };
+
+                    // Inserts a key into a sorted key array, shifting the larger keys to the right.
+                    static void insertSorted(unsigned char* keys, RadixNode** children, unsigned short size, unsigned char key, RadixNode* child) {
+                        unsigned short position = 0;
+                        while (position < size && keys[position] < key) {
+                            ++position;
+                        }
+                        for (unsigned short i = size; i > position; --i) {
+                            keys[i] = keys[i - 1];
+                            children[i] = children[i - 1];
+                        }
+                        keys[position] = key;
+                        children[position] = child;
+                    }
+
+                    // Removes the key at the given position of a sorted key array.
+                    static void eraseSorted(unsigned char* keys, RadixNode** children, unsigned short size, unsigned short position) {
+                        for (unsigned short i = position; i + 1 < size; ++i) {
+                            keys[i] = keys[i + 1];
+                            children[i] = children[i + 1];
+                        }
+                    }
+
+                    static int findSorted(const unsigned char* keys, unsigned short size, unsigned char key) {
+                        for (unsigned short i = 0; i < size; ++i) {
+                            if (keys[i] == key) {
+                                return i;
+                            }
+                        }
+                        return -1;
+                    }
+
+                    template <typename Block>
+                    static Block* allocateBlock(NodePool& pool) {
+                        return new (pool.allocate(sizeof(Block))) Block();
+                    }
+
+                    template <typename Block>
+                    static void freeBlock(NodePool& pool, Block* block) {
+                        pool.deallocate(block, sizeof(Block));
+                    }
+
+                    // Moves all children into a larger layout.
+                    void grow(NodePool& pool) {
+                        if (kind == Kind::Node4) {
+                            Node16* bigger = allocateBlock<Node16>(pool);
+                            std::copy(n4.keys, n4.keys + count, bigger->keys);
+                            std::copy(n4.children, n4.children + count, bigger->children);
+                            n16 = bigger;
+                            kind = Kind::Node16;
+                        }
+                        else if (kind == Kind::Node16) {
+                            Node48* bigger = allocateBlock<Node48>(pool);
+                            for (unsigned short i = 0; i < count; ++i) {
+                                bigger->index[n16->keys[i]] = static_cast<unsigned char>(i + 1);
+                                bigger->children[i] = n16->children[i];
+                            }
+                            freeBlock(pool, n16);
+                            n48 = bigger;
+                            kind = Kind::Node48;
+                        }
+                        else if (kind == Kind::Node48) {
+                            Node256* bigger = allocateBlock<Node256>(pool);
+                            for (int key = 0; key < 256; ++key) {
+                                if (n48->index[key]) {
+                                    bigger->children[key] = n48->children[n48->index[key] - 1];
+                                }
+                            }
+                            freeBlock(pool, n48);
+                            n256 = bigger;
+                            kind = Kind::Node256;
+                        }
+                    }
+
+                    // Moves all children into a smaller layout once the fan-out has dropped well below capacity.
+                    void shrink(NodePool& pool) {
+                        if (kind == Kind::Node16 && count <= 3) {
+                            Node16* old = n16;
+                            std::copy(old->keys, old->keys + count, n4.keys);
+                            std::copy(old->children, old->children + count, n4.children);
+                            freeBlock(pool, old);
+                            kind = Kind::Node4;
+                        }
+                        else if (kind == Kind::Node48 && count <= 12) {
+                            Node48* old = n48;
+                            Node16* smaller = allocateBlock<Node16>(pool);
+                            unsigned short size = 0;
+                            for (int key = 0; key < 256; ++key) {
+                                if (old->index[key]) {
+                                    smaller->keys[size] = static_cast<unsigned char>(key);
+                                    smaller->children[size] = old->children[old->index[key] - 1];
+                                    ++size;
+                                }
+                            }
+                            freeBlock(pool, old);
+                            n16 = smaller;
+                            kind = Kind::Node16;
+                        }
+                        else if (kind == Kind::Node256 && count <= 37) {
+                            Node256* old = n256;
+                            Node48* smaller = allocateBlock<Node48>(pool);
+                            unsigned char slot = 0;
+                            for (int key = 0; key < 256; ++key) {
+                                if (old->children[key]) {
+                                    smaller->index[key] = static_cast<unsigned char>(slot + 1);
+                                    smaller->children[slot++] = old->children[key];
+                                }
+                            }
+                            freeBlock(pool, old);
+                            n48 = smaller;
+                            kind = Kind::Node48;
+                        }
+                    }
+
+                public:
+                    ChildTable() : kind(Kind::Node4), count(0), n4() {
+
+                    }
+
+                    ChildTable(const ChildTable&) = delete;
+                    ChildTable& operator=(const ChildTable&) = delete;
+
+                    /**
+                     * @brief Returns the table's own storage to the pool. The children are not touched.
+                     */
+                    void releaseStorage(NodePool& pool) {
+                        switch (kind) {
+                            case Kind::Node16: freeBlock(pool, n16); break;
+                            case Kind::Node48: freeBlock(pool, n48); break;
+                            case Kind::Node256: freeBlock(pool, n256); break;
+                            default: break;
+                        }
+                        kind = Kind::Node4;
+                        count = 0;
+                    }
+
+                    size_t size() const {
+                        return count;
+                    }
+
+                    bool empty() const {
+                        return count == 0;
+                    }
+
+                    // Allocates the layout that fits the expected number of children right away. The table has to be empty.
+                    void reserve(size_t expected, NodePool& pool) {
+                        if (expected > 48) {
+                            n256 = allocateBlock<Node256>(pool);
+                            kind = Kind::Node256;
+                        }
+                        else if (expected > 16) {
+                            n48 = allocateBlock<Node48>(pool);
+                            kind = Kind::Node48;
+                        }
+                        else if (expected > 4) {
+                            n16 = allocateBlock<Node16>(pool);
+                            kind = Kind::Node16;
+                        }
+                    }
+
+                    // Position of the layout in Statistics::nodesByType.
+                    size_t layout() const {
+                        return static_cast<size_t>(kind);
+                    }
+
+                    // Bytes of the separately allocated block; a Node4 table lives inside the node.
+                    size_t storageBytes() const {
+                        switch (kind) {
+                            case Kind::Node16: return sizeof(Node16);
+                            case Kind::Node48: return sizeof(Node48);
+                            case Kind::Node256: return sizeof(Node256);
+                            default: return 0;
+                        }
+                    }
+
+                    /**
+                     * @brief Finds the child stored under the given key.
+                     * @return Pointer to the child, nullptr if there is none.
+                     */
+                    RadixNode* find(unsigned char key) const {
+                        int position;
+                        switch (kind) {
+                            case Kind::Node4:
+                                position = findSorted(n4.keys, count, key);
+                                return position < 0 ? nullptr : n4.children[position];
+                            case Kind::Node16:
+                                position = PrefixMatch::findKey16(n16->keys, count, key);
+                                return position < 0 ? nullptr : n16->children[position];
+                            case Kind::Node48:
+                                return n48->index[key] ? n48->children[n48->index[key] - 1] : nullptr;
+                            default:
+                                return n256->children[key];
+                        }
+                    }
+
+                    /**
+                     * @brief Starts loading the memory find() will read for the given key.
+                     * @return False if the table is stored inline in the node, so there is nothing to load.
+                     */
+                    bool prefetch(unsigned char key) const {
+                        switch (kind) {
+                            case Kind::Node4:
+                                return false;
+                            case Kind::Node16:
+                                RadixImpl::prefetch(n16, sizeof(Node16));
+                                return true;
+                            case Kind::Node48:
+                                RadixImpl::prefetch(&n48->index[key]);
+                                return true;
+                            default:
+                                RadixImpl::prefetch(&n256->children[key]);
+                                return true;
+                        }
+                    }
+
+                    /**
+                     * @brief Finds the slot holding the child stored under the given key, so that it can be replaced.
+                     * @return Pointer to the slot, nullptr if there is no such child.
+                     */
+                    RadixNode** findSlot(unsigned char key) {
+                        int position;
+                        switch (kind) {
+                            case Kind::Node4:
+                                position = findSorted(n4.keys, count, key);
+                                return position < 0 ? nullptr : &n4.children[position];
+                            case Kind::Node16:
+                                position = PrefixMatch::findKey16(n16->keys, count, key);
+                                return position < 0 ? nullptr : &n16->children[position];
+                            case Kind::Node48:
+                                return n48->index[key] ? &n48->children[n48->index[key] - 1] : nullptr;
+                            default:
+                                return n256->children[key] ? &n256->children[key] : nullptr;
+                        }
+                    }
+
+                    /**
+                     * @brief Adds a child under a key that isn't present yet, growing the layout if it is full.
+                     * The child stays owned by the tree, which frees it through RadixImpl::destroyNode.
+                     */
+                    void insert(unsigned char key, RadixNode* child, NodePool& pool) {
+                        if ((kind == Kind::Node4 && count == 4) || (kind == Kind::Node16 && count == 16) || (kind == Kind::Node48 && count == 48)) {
+                            grow(pool);
+                        }
+
+                        switch (kind) {
+                            case Kind::Node4:
+                                insertSorted(n4.keys, n4.children, count, key, child);
+                                break;
+                            case Kind::Node16:
+                                insertSorted(n16->keys, n16->children, count, key, child);
+                                break;
+                            case Kind::Node48: {
+                                unsigned char slot = 0;
+                                while (n48->children[slot]) {
+                                    ++slot;
+                                }
+                                n48->children[slot] = child;
+                                n48->index[key] = static_cast<unsigned char>(slot + 1);
+                                break;
+                            }
+                            default:
+                                n256->children[key] = child;
+                                break;
+                        }
+                        ++count;
+                    }
+
+                    /**
+                     * @brief Removes the child stored under the given key without deleting it.
+                     * @return The detached child (the caller becomes responsible for it), nullptr if there was none.
+                     */
+                    RadixNode* detach(unsigned char key, NodePool& pool) {
+                        RadixNode* child = nullptr;
+                        int position;
+                        switch (kind) {
+                            case Kind::Node4:
+                                position = findSorted(n4.keys, count, key);
+                                if (position < 0) {
+                                    return nullptr;
+                                }
+                                child = n4.children[position];
+                                eraseSorted(n4.keys, n4.children, count, static_cast<unsigned short>(position));
+                                break;
+                            case Kind::Node16:
+                                position = PrefixMatch::findKey16(n16->keys, count, key);
+                                if (position < 0) {
+                                    return nullptr;
+                                }
+                                child = n16->children[position];
+                                eraseSorted(n16->keys, n16->children, count, static_cast<unsigned short>(position));
+                                break;
+                            case Kind::Node48:
+                                if (!n48->index[key]) {
+                                    return nullptr;
+                                }
+                                child = n48->children[n48->index[key] - 1];
+                                n48->children[n48->index[key] - 1] = nullptr;
+                                n48->index[key] = 0;
+                                break;
+                            default:
+                                child = n256->children[key];
+                                if (!child) {
+                                    return nullptr;
+                                }
+                                n256->children[key] = nullptr;
+                                break;
+                        }
+                        --count;
+                        shrink(pool);
+                        return child;
+                    }
+
+                    /**
+                     * @brief Finds the child with the smallest key greater than the given one.
+                     * @param after The key to continue after, -1 to start from the first child.
+                     * @param key Receives the key of the found child.
+                     * @return The child, nullptr if there are no more children.
+                     */
+                    RadixNode* nextChild(int after, unsigned char& key) const {
+                        switch (kind) {
+                            case Kind::Node4:
+                                for (unsigned short i = 0; i < count; ++i) {
+                                    if (n4.keys[i] > after) {
+                                        key = n4.keys[i];
+                                        return n4.children[i];
+                                    }
+                                }
+                                return nullptr;
+                            case Kind::Node16:
+                                for (unsigned short i = 0; i < count; ++i) {
+                                    if (n16->keys[i] > after) {
+                                        key = n16->keys[i];
+                                        return n16->children[i];
+                                    }
+                                }
+                                return nullptr;
+                            case Kind::Node48:
+                                for (int next = after + 1; next < 256; ++next) {
+                                    if (n48->index[next]) {
+                                        key = static_cast<unsigned char>(next);
+                                        return n48->children[n48->index[next] - 1];
+                                    }
+                                }
+                                return nullptr;
+                            default:
+                                for (int next = after + 1; next < 256; ++next) {
+                                    if (n256->children[next]) {
+                                        key = static_cast<unsigned char>(next);
+                                        return n256->children[next];
+                                    }
+                                }
+                                return nullptr;
+                        }
+                    }
+
+                    /**
+                     * @brief Calls func(key, child) for every child in ascending key order.
+                     */
+                    template <typename Func>
+                    void forEach(Func&& func) const {
+                        switch (kind) {
+                            case Kind::Node4:
+                                for (unsigned short i = 0; i < count; ++i) {
+                                    func(n4.keys[i], n4.children[i]);
+                                }
+                                break;
+                            case Kind::Node16:
+                                for (unsigned short i = 0; i < count; ++i) {
+                                    func(n16->keys[i], n16->children[i]);
+                                }
+                                break;
+                            case Kind::Node48:
+                                for (int key = 0; key < 256; ++key) {
+                                    if (n48->index[key]) {
+                                        func(static_cast<unsigned char>(key), n48->children[n48->index[key] - 1]);
+                                    }
+                                }
+                                break;
+                            default:
+                                for (int key = 0; key < 256; ++key) {
+                                    if (n256->children[key]) {
+                                        func(static_cast<unsigned char>(key), n256->children[key]);
+                                    }
+                                }
+                                break;
+                        }
+                    }
+            };
+
             /**
              * @brief Represents a radix tree's node.
              */
             struct RadixNode {
-                ValueType word; // The prefix being stored in the node.
-                std::unordered_map<char, std::unique_ptr<RadixNode>> children; // Map of all children of the current node.
+                Label word; // The prefix being stored in the node.
+                ChildTable children; // Adaptive table of all children of the current node, keyed by their first character.
                 bool isEndOfWord; // Marker to mark wheter this node represents an ending of a word.
+                std::uint32_t wordCount; // Number of words ending at this node or anywhere below it.
+
+                /**
+                 * @brief Constructs an empty radix tree node.
+                 * @param data Pointer to the word (prefix) to be saved at the current node.
+                 * @param length Length of the prefix.
+                 * @param pool Pool the label's bytes are taken from.
+                 * By default isEndOfWord marker is assigned to false,
+                 * as the program will determine whether this is trule the end of a word later.
+                 */
+                RadixNode(const char* data, size_t length, NodePool& pool) : word(data, length, PoolAllocator<char>(pool.isArena() ? &pool : nullptr)), isEndOfWord(false), wordCount(0) {
+
+                };
+            };
+
+            static void prefetchNode(const RadixNode* node) {
+                prefetch(node, sizeof(RadixNode));
+            }
+
+            NodePool pool;
+            // Arena trees whose nodes this tree took over. Their slabs have to live as long as this tree.
+            std::vector<std::unique_ptr<RadixImpl>> donors;
+            // Nodes on the way down of the insert in progress, kept between inserts so they don't allocate.
+            std::vector<RadixNode*> insertPath;
+            // Every word spelled backwards while the suffix index is on, changed along with the tree.
+            std::unique_ptr<RadixTree> reversed;
+#ifdef RADIX_TREE_STATS
+            size_t splits = 0;
+            size_t merges = 0;
+#endif
+
+            /**
+             * @brief Constructor that automatically craetes a root node.
+             * @param useArena Whether nodes are taken from the tree's own slabs instead of the heap.
+             */
+            RadixNode* root;
+            explicit RadixImpl(bool useArena = false) : pool(useArena), root(nullptr) {
+                root = createNode("", 0);
+            }
+
+            /**
+             * @brief Destructor that frees any alocated memory.
+             */
+            ~RadixImpl() {
+                deleteTree();
+            }
+
+            /**
+             * @brief Compares if trees are equal (have the same saved words).
+             * @param thisNode Current node.
+             * @param otherNode Node to compare with.
+             * @return True if they are equal, false otherwise.
+             */
+            bool compareTrees(const RadixNode* thisNode, const RadixNode* otherNode) const {
+                if (!thisNode && !otherNode) {
+                    return true;
+                }
+                if (!thisNode || !otherNode) {
+                    return false;
+                }
+
+                if (thisNode->word != otherNode->word || thisNode->isEndOfWord != otherNode->isEndOfWord || thisNode->children.size() != otherNode->children.size()) {
+                    return false;
+                }
+
+                bool equal = true;
+                thisNode->children.forEach([&](unsigned char thisNodesChar, const RadixNode* thisNodesChild) {
+                    if (!equal) {
+                        return;
+                    }
+
+                    const RadixNode* matchingChild = otherNode->children.find(thisNodesChar);
+                    if (!matchingChild || !compareTrees(thisNodesChild, matchingChild)) {
+                        equal = false;
+                    }
+                });
+
+                return equal;
+            }
+
+            /**
+             * @brief Walks down the tree along the given text.
+             * @param text The text to follow.
+             * @param labelStart Receives the position in the text where the returned node's label starts.
+             * @return The node where the text ends, at the end or in the middle of its label. The root for an empty text,
+             * nullptr if no word continues the text.
+             */
+            const RadixNode* findPrefixNode(std::string_view text, size_t& labelStart) const {
+                const RadixNode* node = root;
+                size_t index = 0;
+                labelStart = 0;
+
+                while (index < text.size()) {
+                    const RadixNode* child = node->children.find(text[index]);
+                    if (!child) {
+                        return nullptr;
+                    }
+
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->word.data(), text.data() + index, std::min<size_t>(child->word.size(), text.size() - index));
+                    // The text may only stop matching where it runs out.
+                    if (matchingLength != child->word.size() && index + matchingLength != text.size()) {
+                        return nullptr;
+                    }
+
+                    node = child;
+                    labelStart = index;
+                    index += matchingLength;
+                }
+
+                return node;
+            }
+
+            /**
+             * @brief Looks up a group of words in lock-step, so the cache misses of different words overlap.
+             *
+             * Each lookup advances by one step per round and prefetches the memory its next step reads:
+             * the child table of the node it reached, then the child itself. By the time the round comes back
+             * to it the line is usually loaded, while the other lookups of the group were waiting on their own misses.
+             * A finished lookup hands its place to the next word.
+             */
+            template <typename Word>
+            void searchBatch(const std::vector<Word>& words, std::vector<bool>& found) const {
+                static constexpr size_t groupSize = 16;
+
+                enum class Step : unsigned char { CompareLabel, FindChild };
+
+                struct Lookup {
+                    const RadixNode* node;
+                    size_t word; // Index of the word in the batch.
+                    size_t index; // Position in the word where the node's label starts, or ends once it has been compared.
+                    Step step;
+                };
+
+                found.assign(words.size(), false);
+                Lookup group[groupSize];
+                size_t active = 0;
+                size_t next = 0;
+                while (active < groupSize && next < words.size()) {
+                    group[active++] = {root, next++, 0, Step::CompareLabel};
+                }
+
+                while (active > 0) {
+                    for (size_t i = 0; i < active;) {
+                        Lookup& lookup = group[i];
+                        std::string_view word = words[lookup.word];
+                        bool finished = false;
+
+                        if (lookup.step == Step::CompareLabel) {
+                            const Label& label = lookup.node->word;
+                            if (word.compare(lookup.index, label.size(), std::string_view(label.data(), label.size())) != 0) {
+                                finished = true;
+                            }
+                            else if ((lookup.index += label.size()) == word.size()) {
+                                found[lookup.word] = lookup.node->isEndOfWord;
+                                finished = true;
+                            }
+                            else {
+                                lookup.step = Step::FindChild;
+                                // A table stored inline in the node is already loaded, so its child is looked up right away.
+                                if (lookup.node->children.prefetch(word[lookup.index])) {
+                                    ++i;
+                                    continue;
+                                }
+                            }
+                        }
+
+                        if (!finished) {
+                            const RadixNode* child = lookup.node->children.find(word[lookup.index]);
+                            if (!child) {
+                                finished = true;
+                            }
+                            else {
+                                prefetchNode(child);
+                                lookup.node = child;
+                                lookup.step = Step::CompareLabel;
+                            }
+                        }
+
+                        if (!finished) {
+                            ++i;
+                        }
+                        else if (next < words.size()) {
+                            group[i++] = {root, next++, 0, Step::CompareLabel};
+                        }
+                        else {
+                            group[i] = group[--active];
+                        }
+                    }
+                }
+            }
+
+            /**
+             * @brief State of a fuzzy search: the query, the edit distance rows along the current path and the best matches so far.
+             */
+            struct FuzzySearch {
+                std::string_view target;
+                size_t maxDistance;
+                size_t limit;
+                ValueType word; // Text spelled out by the current path.
+                std::vector<size_t> rows; // Row i holds the distances between the first i characters of word and every prefix of target.
+                std::vector<std::pair<size_t, ValueType>> best; // Max-heap of at most limit (distance, word) matches.
+
+                // Cells outside the band, further than any bound.
+                static constexpr size_t farAway = SIZE_MAX / 2;
+                // No edit distance comes near this, so a larger maxDistance is clamped to it. The band arithmetic then can't overflow.
+                static constexpr size_t unlimited = SIZE_MAX / 4;
+
+                // Matches have to be closer than this. Once the heap is full, a tie loses to the earlier, smaller word.
+                size_t bound() const {
+                    return best.size() == limit ? best.front().first : maxDistance + 1;
+                }
+            };
+
+            /**
+             * @brief Appends one character to the current path and computes its edit distance row.
+             *
+             * Only the diagonal band of cells that can still stay below the bound is computed: a cell further
+             * than bound - 1 from the diagonal already needs that many insertions or deletions. The cells just
+             * outside the band are set to farAway, so the next row reads them as too distant.
+             * @return false, leaving the path as it was, when every cell of the row reaches the bound.
+             * Appending more characters never lowers the smallest one, so nothing below the path can match.
+             */
+            static bool extendPath(FuzzySearch& search, char c) {
+                constexpr size_t farAway = FuzzySearch::farAway;
+                size_t length = search.target.size();
+                size_t width = length + 1;
+                size_t bound = search.bound();
+                size_t row = search.word.size() + 1;
+                size_t low = row + 1 > bound ? row + 1 - bound : 0;
+                size_t high = std::min(length, row + bound - 1);
+                if (bound == 0 || low > high) {
+                    return false;
+                }
+
+                search.rows.resize((row + 1) * width);
+                const size_t* previous = &search.rows[(row - 1) * width];
+                size_t* current = &search.rows[row * width];
+                size_t rowMinimum = farAway;
+                size_t j = low;
+                if (low == 0) {
+                    current[0] = row;
+                    rowMinimum = row;
+                    j = 1;
+                }
+                else {
+                    current[low - 1] = farAway;
+                }
+                for (; j <= high; ++j) {
+                    current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + (search.target[j - 1] != c)});
+                    rowMinimum = std::min(rowMinimum, current[j]);
+                }
+                if (high < length) {
+                    current[high + 1] = farAway;
+                }
+                if (rowMinimum >= bound) {
+                    return false;
+                }
+                search.word.push_back(c);
+                return true;
+            }
+
+            /**
+             * @brief Extends the edit distance table by the rest of a node's label, then visits its children in order.
+             *
+             * A child's first character is its key in the parent's table, so the row for it is computed
+             * before the child is loaded. Most children of a busy node fail right there and are never touched.
+             * @param labelStart Number of label characters the caller has already appended.
+             */
+            static void fuzzyWalk(const RadixNode* node, size_t labelStart, FuzzySearch& search) {
+                size_t startLength = search.word.size() - labelStart;
+                for (size_t i = labelStart; i < node->word.size(); ++i) {
+                    if (!extendPath(search, node->word[i])) {
+                        search.word.resize(startLength);
+                        return;
+                    }
+                }
+
+                // The last cell is only filled in while it lies inside the band.
+                size_t length = search.target.size();
+                size_t row = search.word.size();
+                size_t bound = search.bound();
+                bool inBand = length < row + bound && row < length + bound;
+                if (node->isEndOfWord && inBand && search.rows[row * (length + 1) + length] < bound) {
+                    size_t distance = search.rows[row * (length + 1) + length];
+                    if (search.best.size() == search.limit) {
+                        std::pop_heap(search.best.begin(), search.best.end());
+                        search.best.pop_back();
+                    }
+                    search.best.emplace_back(distance, search.word);
+                    std::push_heap(search.best.begin(), search.best.end());
+                }
+
+                node->children.forEach([&](unsigned char key, const RadixNode* child) {
+                    if (extendPath(search, static_cast<char>(key))) {
+                        fuzzyWalk(child, 1, search);
+                    }
+                });
+                search.word.resize(startLength);
+            }
+
+            /**
+             * @brief A glob pattern compiled into a chain of NFA positions, one per pattern element.
+             * Position i means the first i elements are matched; a star can also consume characters
+             * without moving on, and is skipped for free. Position count() accepts.
+             */
+            struct GlobPattern {
+                struct Element {
+                    bool anyString; // A '*'; the character set is unused.
+                    std::bitset<256> accepts; // Characters a '?', a character class or a literal matches.
+                };
+                std::vector<Element> elements;
+                size_t acceptsRest; // Once this position is reached, every continuation matches. SIZE_MAX without a trailing star.
+
+                explicit GlobPattern(std::string_view pattern) {
+                    for (size_t i = 0; i < pattern.size(); ++i) {
+                        Element element{false, {}};
+                        char c = pattern[i];
+                        if (c == '*') {
+                            // Consecutive stars match the same words as one.
+                            if (elements.empty() || !elements.back().anyString) {
+                                elements.push_back({true, {}});
+                            }
+                            continue;
+                        }
+                        if (c == '?') {
+                            element.accepts.set();
+                        }
+                        else if (c == '[') {
+                            i = parseClass(pattern, i, element.accepts);
+                        }
+                        else {
+                            if (c == '\\') {
+                                if (++i == pattern.size()) {
+                                    throw MyException("The pattern ends with an escape character");
+                                }
+                                c = pattern[i];
+                            }
+                            element.accepts.set(static_cast<unsigned char>(c));
+                        }
+                        elements.push_back(element);
+                    }
+                    acceptsRest = !elements.empty() && elements.back().anyString ? elements.size() - 1 : SIZE_MAX;
+                }
+
+                size_t count() const {
+                    return elements.size();
+                }
+
+                /**
+                 * @brief Parses a [...] class starting at pattern[start]: ranges like a-c, and ! or ^ to negate.
+                 * A ']' right after the opening bracket (or negation) is taken literally.
+                 * @return Position of the closing bracket.
+                 */
+                static size_t parseClass(std::string_view pattern, size_t start, std::bitset<256>& accepts) {
+                    size_t i = start + 1;
+                    bool negated = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+                    if (negated) {
+                        ++i;
+                    }
+                    size_t first = i;
+                    for (; i < pattern.size() && (pattern[i] != ']' || i == first); ++i) {
+                        unsigned char low = pattern[i];
+                        unsigned char high = low;
+                        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+                            high = pattern[i + 2];
+                            i += 2;
+                        }
+                        for (unsigned c = low; c <= high; ++c) {
+                            accepts.set(c);
+                        }
+                    }
+                    if (i == pattern.size()) {
+                        throw MyException("Unterminated character class in the pattern");
+                    }
+                    if (negated) {
+                        accepts.flip();
+                    }
+                    return i;
+                }
+            };
+
+            /**
+             * @brief State of a glob match: the automaton state sets along the current path and the reporting limit.
+             */
+            struct GlobMatch {
+                const GlobPattern& pattern;
+                const std::function<void(const ValueType&)>& callback;
+                size_t limit;
+                size_t reported;
+                ValueType word; // Text spelled out by the current path.
+                std::vector<unsigned char> states; // Set i flags the positions active after the first i characters of word.
+
+                bool finished() const {
+                    return reported == limit;
+                }
+
+                const unsigned char* current() const {
+                    return &states[word.size() * (pattern.count() + 1)];
+                }
+
+                // Whether the current path has reached the trailing star.
+                bool acceptsEverything() const {
+                    return pattern.acceptsRest != SIZE_MAX && current()[pattern.acceptsRest];
+                }
+
+                // Follows the free moves past stars, so every position a set could be in is flagged.
+                void close(unsigned char* set) const {
+                    for (size_t i = 0; i < pattern.count(); ++i) {
+                        if (set[i] && pattern.elements[i].anyString) {
+                            set[i + 1] = 1;
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Appends one character to the current path and steps the automaton on it.
+                 * @return false, leaving the path as it was, when no position survives.
+                 */
+                bool extendPath(char c) {
+                    size_t width = pattern.count() + 1;
+                    size_t depth = word.size();
+                    states.resize((depth + 2) * width);
+                    const unsigned char* previous = &states[depth * width];
+                    unsigned char* next = &states[(depth + 1) * width];
+                    std::fill(next, next + width, 0);
+                    bool alive = false;
+                    for (size_t i = 0; i < pattern.count(); ++i) {
+                        if (!previous[i]) {
+                            continue;
+                        }
+                        const GlobPattern::Element& element = pattern.elements[i];
+                        if (element.anyString) {
+                            next[i] = 1;
+                            alive = true;
+                        }
+                        else if (element.accepts.test(static_cast<unsigned char>(c))) {
+                            next[i + 1] = 1;
+                            alive = true;
+                        }
+                    }
+                    if (!alive) {
+                        return false;
+                    }
+                    close(next);
+                    word.push_back(c);
+                    return true;
+                }
+            };
+
+            // Reports every word in a subtree, for paths the pattern's trailing star already accepts.
+            static void globReportAll(const RadixNode* node, size_t labelStart, GlobMatch& match) {
+                size_t startLength = match.word.size() - labelStart;
+                match.word.append(node->word, labelStart, ValueType::npos);
+                if (node->isEndOfWord) {
+                    match.callback(match.word);
+                    ++match.reported;
+                }
+                node->children.forEach([&](unsigned char, const RadixNode* child) {
+                    if (!match.finished()) {
+                        globReportAll(child, 0, match);
+                    }
+                });
+                match.word.resize(startLength);
+            }
+
+            /**
+             * @brief Steps the automaton along the rest of a node's label, then visits its children in order.
+             *
+             * Like fuzzyWalk, a child's first character is stepped on from its key in the parent's table,
+             * so children the automaton can't enter are never loaded.
+             * @param labelStart Number of label characters the caller has already appended.
+             */
+            static void globWalk(const RadixNode* node, size_t labelStart, GlobMatch& match) {
+                size_t startLength = match.word.size() - labelStart;
+                for (size_t i = labelStart; i < node->word.size(); ++i) {
+                    if (match.acceptsEverything()) {
+                        // Only the trailing star is left, so the automaton doesn't need to run any further.
+                        globReportAll(node, i, match);
+                        match.word.resize(startLength);
+                        return;
+                    }
+                    if (!match.extendPath(node->word[i])) {
+                        match.word.resize(startLength);
+                        return;
+                    }
+                }
+
+                if (match.acceptsEverything()) {
+                    globReportAll(node, node->word.size(), match);
+                    match.word.resize(startLength);
+                    return;
+                }
+                if (node->isEndOfWord && match.current()[match.pattern.count()]) {
+                    match.callback(match.word);
+                    ++match.reported;
+                }
+
+                node->children.forEach([&](unsigned char key, const RadixNode* child) {
+                    if (!match.finished() && match.extendPath(static_cast<char>(key))) {
+                        globWalk(child, 1, match);
+                    }
+                });
+                match.word.resize(startLength);
+            }
+
+            // Adds a value to a histogram, growing it as needed.
+            static void addToHistogram(std::vector<size_t>& histogram, size_t value) {
+                if (histogram.size() <= value) {
+                    histogram.resize(value + 1);
+                }
+                ++histogram[value];
+            }
+
+            // Adds a subtree to the shape statistics.
+            static void measureShape(const RadixNode* node, size_t depth, Statistics& statistics) {
+                ++statistics.nodeCount;
+                statistics.labelBytes += node->word.size();
+                addToHistogram(statistics.depthHistogram, depth);
+                addToHistogram(statistics.fanOutHistogram, node->children.size());
+                addToHistogram(statistics.labelLengthHistogram, node->word.size());
+                ++statistics.nodesByType[node->children.layout()];
+                statistics.bytesByType[node->children.layout()] += sizeof(RadixNode) + node->children.storageBytes();
+                node->children.forEach([&](unsigned char, const RadixNode* child) {
+                    measureShape(child, depth + 1, statistics);
+                });
+            }
+
+            // Creates a node in the tree's pool.
+            RadixNode* createNode(const char* data, size_t length) {
+                return new (pool.allocate(sizeof(RadixNode))) RadixNode(data, length, pool);
+            }
+
+            // Returns a single node to the pool. Its children have to be detached or destroyed already.
+            void destroyNode(RadixNode* node) {
+                node->children.releaseStorage(pool);
+                node->~RadixNode();
+                pool.deallocate(node, sizeof(RadixNode));
+            }
+
+            // Destroys a node together with all of its descendants.
+            void destroySubtree(RadixNode* node) {
+                if (!node) {
+                    return;
+                }
+                node->children.forEach([&](unsigned char, RadixNode* child) {
+                    destroySubtree(child);
+                });
+                destroyNode(node);
+            }
+
+            /**
+             * @brief Deep copies a subtree of (possibly) another tree into this tree's pool.
+             */
+            RadixNode* copyRadixTree(const RadixNode* node) {
+                if (!node) {
+                    return nullptr;
+                }
+                RadixNode* copy = createNode(node->word.data(), node->word.size());
+                copy->isEndOfWord = node->isEndOfWord;
+                copy->wordCount = node->wordCount;
+                node->children.forEach([&](unsigned char key, const RadixNode* child) {
+                    copy->children.insert(key, copyRadixTree(child), pool);
+                });
+                return copy;
+            }
+
+            // Length of the common prefix of two labels, starting at the given offsets.
+            static size_t commonPrefixLength(const Label& first, size_t firstOffset, const Label& second, size_t secondOffset) {
+                return PrefixMatch::commonPrefixLength(first.data() + firstOffset, second.data() + secondOffset, std::min(first.size() - firstOffset, second.size() - secondOffset));
+            }
+
+            // Sets a node's word count from its own marker and its children's counts.
+            static void recount(RadixNode* node) {
+                std::uint32_t count = node->isEndOfWord;
+                node->children.forEach([&](unsigned char, const RadixNode* child) {
+                    count += child->wordCount;
+                });
+                node->wordCount = count;
+            }
+
+            /**
+             * @brief Splits a node's label at the given position.
+             * @return New node holding the first part of the label, with the shortened node as its only child.
+             */
+            RadixNode* splitNode(RadixNode* node, size_t position) {
+                RadixNode* upper = createNode(node->word.data(), position);
+                upper->wordCount = node->wordCount;
+                node->word.erase(0, position);
+                upper->children.insert(node->word[0], node, pool);
+                return upper;
+            }
+
+            // Adds a word to the tree and its suffix index. Returns false, leaving both unchanged, if the word is already in the tree.
+            bool insertWord(std::string_view word) {
+                if (!insertNodes(word)) {
+                    return false;
+                }
+                if (reversed) {
+                    reversed->pImpl->insertNodes(reverse(word));
+                }
+                return true;
+            }
+
+            // Removes a word from the tree and its suffix index. Returns false, leaving both unchanged, if the word isn't in the tree.
+            bool removeWord(std::string_view word) {
+                if (!removeNodes(word)) {
+                    return false;
+                }
+                if (reversed) {
+                    reversed->pImpl->removeNodes(reverse(word));
+                }
+                return true;
+            }
+
+            // Counts the word just inserted in every node on the way down to it.
+            void countInsertPath() {
+                for (RadixNode* node : insertPath) {
+                    ++node->wordCount;
+                }
+            }
+
+            // Adds a word to the nodes of the tree. Returns false, leaving the tree unchanged, if the word is already in it.
+            bool insertNodes(std::string_view word) {
+                RadixNode* node = root;
+                size_t index = 0;
+                // The nodes on the way down gain a word once the word turns out not to be a duplicate, so a duplicate writes nothing.
+                insertPath.clear();
+                insertPath.push_back(node);
+
+                while (index < word.size()) {
+                    unsigned char c = word[index];
+                    RadixNode** childSlot = node->children.findSlot(c);
+                    /**
+                     * Create a child node if none exists matching the prefix.
+                     * Place the prefix into the child node.
+                    */
+                    if (!childSlot) {
+                        RadixNode* leaf = createNode(word.data() + index, word.size() - index);
+                        leaf->isEndOfWord = true;
+                        leaf->wordCount = 1;
+                        node->children.insert(c, leaf, pool);
+                        countInsertPath();
+                        return true;
+                    }
+
+                    RadixNode* child = *childSlot;
+                    // Check to see how much of the prefix matches.
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->word.data(), word.data() + index, std::min<size_t>(child->word.size(), word.size() - index));
+                    // If the entire child's prefix matches, move to it.
+                    if (matchingLength == child->word.size()) {
+                        node = child;
+                        index += matchingLength;
+                        insertPath.push_back(node);
+                    }
+                    /**
+                     * Else, split the node, look for how long the two match,
+                     * once they don't match, save the matching part as the new prefix for the child,
+                     * place the rest of child's prefix into a grandchild node,
+                     * and create another grandchild, placing the prefix there.
+                     */
+                    else {
+#ifdef RADIX_TREE_STATS
+                        ++splits;
+#endif
+                        RadixNode* nodeSplit = createNode(child->word.data(), matchingLength);
+                        nodeSplit->isEndOfWord = false;
+                        nodeSplit->wordCount = child->wordCount + 1;
+                        child->word.erase(0, matchingLength);
+                        nodeSplit->children.insert(child->word[0], child, pool);
+                        *childSlot = nodeSplit;
+
+                        if (index + matchingLength < word.size()) {
+                            RadixNode* leaf = createNode(word.data() + index + matchingLength, word.size() - index - matchingLength);
+                            leaf->isEndOfWord = true;
+                            leaf->wordCount = 1;
+                            nodeSplit->children.insert(word[index + matchingLength], leaf, pool);
+                        }
+                        else {
+                            nodeSplit->isEndOfWord = true;
+                        }
+                        countInsertPath();
+                        return true;
+                    }
+                }
+
+                // If the word already exists, the tree stays as it was.
+                if (node->isEndOfWord == true) {
+                    return false;
+                }
+                // Else mark the current node as the end of the word.
+                node->isEndOfWord = true;
+                countInsertPath();
+                return true;
+            }
+
+            // Removes a word from the nodes of the tree. Returns false, leaving the tree unchanged, if the word isn't in it.
+            bool removeNodes(std::string_view word) {
+                RadixNode* node = root;
+                std::vector<std::pair<RadixNode*, unsigned char>> removablePart;
+                size_t index = 0;
+
+                while (node && index < word.size()) {
+                    unsigned char c = word[index];
+                    // If the child with matching prefix doesn't exist, the word isn't in the tree.
+                    RadixNode* child = node->children.find(c);
+                    if (!child) {
+                        return false;
+                    }
+
+                    // Check for how long the prefixes match.
+                    size_t matchingLength = PrefixMatch::commonPrefixLength(child->word.data(), word.data() + index, std::min<size_t>(child->word.size(), word.size() - index));
+                    // If the length doesn't match (meaning the word is shorter than the child prefix), the word isn't in the tree.
+                    if (matchingLength != child->word.size()) {
+                        return false;
+                    }
+
+                    // Save how much of the tree will be deleted.
+                    removablePart.emplace_back(node, c);
+                    node = child;
+                    index += matchingLength;
+                }
+
+                /**
+                 * If:
+                 * 1) node is null,
+                 * 2) current node's prefix isn't marked as an end of a word OR,
+                 * 3) index doesn't match the length of the word,
+                 * the word isn't in the tree.
+                 */
+                if (!node || !node->isEndOfWord || index != word.size()) {
+                    return false;
+                }
+
+                // Remove this prefix as the end of the word.
+                node->isEndOfWord = false;
+                --node->wordCount;
+                for (const auto& [parent, c] : removablePart) {
+                    --parent->wordCount;
+                }
+
+                /**
+                 * Iterate backwards through the nodes (leaf to root),
+                 * checking to see if the child isn't marked as a word ending,
+                 * and doesn't have children.
+                 * If not - deletes it, else - breaks the cycle.
+                 */
+                size_t kept = removablePart.size();
+                while (kept > 0) {
+                    auto [parent, c] = removablePart[kept - 1];
+                    RadixNode* child = parent->children.find(c);
+
+                    if (!child->isEndOfWord && child->children.empty()) {
+                        destroyNode(parent->children.detach(c, pool));
+                        --kept;
+                    }
+                    else {
+                        break;
+                    }
+                }
+
+                // The deepest node left on the path may have become a pass-through node, which is joined with its only child.
+                if (kept > 0) {
+                    auto [parent, c] = removablePart[kept - 1];
+                    pruneChild(parent, c);
+                }
+                return true;
+            }
+
+            static ValueType reverse(std::string_view word) {
+                return ValueType(word.rbegin(), word.rend());
+            }
+
+            // Appends the words below a node to the list, spelled backwards. The prefix holds the text spelled above the node.
+            void collectReversed(const RadixNode* node, ValueType& prefix, std::vector<ValueType>& words) const {
+                prefix.append(node->word.data(), node->word.size());
+                if (node->isEndOfWord) {
+                    words.emplace_back(prefix.rbegin(), prefix.rend());
+                }
+                node->children.forEach([&](unsigned char, const RadixNode* child) {
+                    collectReversed(child, prefix, words);
+                });
+                prefix.resize(prefix.size() - node->word.size());
+            }
+
+            // Builds a tree of this tree's words spelled backwards, in the same allocation mode.
+            RadixTree buildReversed() const {
+                std::vector<ValueType> words;
+                words.reserve(root->wordCount);
+                ValueType prefix;
+                collectReversed(root, prefix, words);
+                std::sort(words.begin(), words.end());
+                return RadixTree::fromSorted(words.begin(), words.end(), pool.isArena() ? AllocationMode::Arena : AllocationMode::Heap);
+            }
+
+            // The other tree's words spelled backwards: its suffix index if it has one, otherwise built into the scratch tree.
+            static const RadixTree& reversedOf(const RadixImpl& other, RadixTree& scratch) {
+                if (other.reversed) {
+                    return *other.reversed;
+                }
+                scratch = other.buildReversed();
+                return scratch;
+            }
+
+            // Inserts every word of a batch, see RadixTree::insertBatch.
+            template <typename Word>
+            size_t insertBatch(const std::vector<Word>& words) {
+                size_t added = 0;
+                for (const auto& word : words) {
+                    added += insertWord(word);
+                }
+                return added;
+            }
+
+            // Removes every word of a batch, see RadixTree::removeBatch.
+            template <typename Word>
+            size_t removeBatch(const std::vector<Word>& words) {
+                size_t removed = 0;
+                for (const auto& word : words) {
+                    removed += removeWord(word);
+                }
+                return removed;
+            }
+
+            // Replaces a pass-through node (no word ends there and it has a single child) by that child, keeping the path compressed.
+            void joinWithChild(RadixNode** slot) {
+                RadixNode* node = *slot;
+                RadixNode* child = nullptr;
+                node->children.forEach([&](unsigned char, RadixNode* only) {
+                    child = only;
+                });
+                child->word.insert(0, node->word);
+                *slot = child;
+                destroyNode(node);
+#ifdef RADIX_TREE_STATS
+                ++merges;
+#endif
+            }
+
+            // Destroys the child stored under the key if no word is left in its subtree, or joins it with its only child if it was left as a pass-through node.
+            void pruneChild(RadixNode* node, unsigned char key) {
+                RadixNode** slot = node->children.findSlot(key);
+                if (!slot) {
+                    return;
+                }
+                if ((*slot)->wordCount == 0) {
+                    destroySubtree(node->children.detach(key, pool));
+                }
+                else if (!(*slot)->isEndOfWord && (*slot)->children.size() == 1) {
+                    joinWithChild(slot);
+                }
+            }
+
+            // Removes every word of a subtree, leaving only its (now empty) root node.
+            void clearSubtree(RadixNode* node) {
+                int after = -1;
+                unsigned char key;
+                while (node->children.nextChild(after, key)) {
+                    destroySubtree(node->children.detach(key, pool));
+                    after = key;
+                }
+                node->isEndOfWord = false;
+                node->wordCount = 0;
+            }
+
+            /**
+             * Structural set operations.
+             * They walk this tree and the other tree together, matching edge labels, instead of re-inserting words one by one.
+             * Offsets mark how much of a label was matched already when one label ends in the middle of the other.
+             * When merging, the source subtrees are either copied or, if Steal is set, moved out of the other tree.
+             */
+            template <bool Steal>
+            using SourceNode = typename std::conditional<Steal, RadixNode, const RadixNode>::type;
+            template <bool Steal>
+            using SourceImpl = typename std::conditional<Steal, RadixImpl, const RadixImpl>::type;
+
+            /**
+             * @brief Makes a subtree of the other tree a part of this tree.
+             * @param parent The subtree's parent in the other tree.
+             * @param key The subtree's key in the parent.
+             * @param offset Number of leading label characters already present in this tree.
+             * @param sourceImpl The other tree.
+             * @return Root of the subtree, now owned by this tree.
+             */
+            template <bool Steal>
+            RadixNode* adoptSubtree(SourceNode<Steal>* parent, unsigned char key, size_t offset, SourceImpl<Steal>& sourceImpl) {
+                RadixNode* subtree;
+                if constexpr (Steal) {
+                    subtree = parent->children.detach(key, sourceImpl.pool);
+                }
+                else {
+                    subtree = copyRadixTree(parent->children.find(key));
+                }
+                subtree->word.erase(0, offset);
+                return subtree;
+            }
+
+            // Merges the words below a source node into a target node spelling the same text.
+            template <bool Steal>
+            void mergeNodes(RadixNode* target, SourceNode<Steal>* source, SourceImpl<Steal>& sourceImpl) {
+                target->isEndOfWord = target->isEndOfWord || source->isEndOfWord;
+
+                int after = -1;
+                unsigned char key;
+                while (SourceNode<Steal>* sourceChild = source->children.nextChild(after, key)) {
+                    after = key;
+                    RadixNode** slot = target->children.findSlot(key);
+                    if (slot) {
+                        mergeEdge<Steal>(slot, source, key, 0, sourceImpl);
+                    }
+                    else {
+                        target->children.insert(key, adoptSubtree<Steal>(source, key, 0, sourceImpl), pool);
+                    }
+                }
+
+                recount(target);
+            }
+
+            /**
+             * @brief Merges a source subtree into the target subtree held in the slot. Both labels start with the same character.
+             * @param slot Slot holding the target subtree, replaced if the target has to be split.
+             * @param sourceParent Parent of the source subtree, the subtree itself is stored under the key.
+             * @param offset Number of the source label's characters matched already.
+             */
+            template <bool Steal>
+            void mergeEdge(RadixNode** slot, SourceNode<Steal>* sourceParent, unsigned char key, size_t offset, SourceImpl<Steal>& sourceImpl) {
+                RadixNode* target = *slot;
+                SourceNode<Steal>* source = sourceParent->children.find(key);
+                size_t sourceLength = source->word.size() - offset;
+                size_t matchingLength = commonPrefixLength(target->word, 0, source->word, offset);
+
+                if (matchingLength == target->word.size()) {
+                    if (matchingLength == sourceLength) {
+                        mergeNodes<Steal>(target, source, sourceImpl);
+                        return;
+                    }
+
+                    // The source label goes on below the target node.
+                    unsigned char next = source->word[offset + matchingLength];
+                    RadixNode** childSlot = target->children.findSlot(next);
+                    if (childSlot) {
+                        mergeEdge<Steal>(childSlot, sourceParent, key, offset + matchingLength, sourceImpl);
+                    }
+                    else {
+                        target->children.insert(next, adoptSubtree<Steal>(sourceParent, key, offset + matchingLength, sourceImpl), pool);
+                    }
+                    recount(target);
+                    return;
+                }
+
+                // The source label ends or branches off inside the target label, so the target is split there.
+                RadixNode* upper = splitNode(target, matchingLength);
+                *slot = upper;
+                if (matchingLength == sourceLength) {
+                    mergeNodes<Steal>(upper, source, sourceImpl);
+                }
+                else {
+                    unsigned char next = source->word[offset + matchingLength];
+                    upper->children.insert(next, adoptSubtree<Steal>(sourceParent, key, offset + matchingLength, sourceImpl), pool);
+                    recount(upper);
+                }
+            }
+
+            // Removes the words below a source node from a target node spelling the same text.
+            void subtractNodes(RadixNode* target, const RadixNode* source) {
+                if (source->isEndOfWord) {
+                    target->isEndOfWord = false;
+                }
+
+                source->children.forEach([&](unsigned char key, const RadixNode* sourceChild) {
+                    RadixNode* child = target->children.find(key);
+                    if (child) {
+                        subtractEdge(child, 0, sourceChild, 0);
+                        pruneChild(target, key);
+                    }
+                });
+
+                recount(target);
+            }
+
+            /**
+             * @brief Removes the words of a source subtree from a target subtree. Both labels start with the same character.
+             * Emptied nodes below the target are pruned, the target itself is left for its parent to prune.
+             */
+            void subtractEdge(RadixNode* target, size_t targetOffset, const RadixNode* source, size_t sourceOffset) {
+                size_t targetLength = target->word.size() - targetOffset;
+                size_t sourceLength = source->word.size() - sourceOffset;
+                size_t matchingLength = commonPrefixLength(target->word, targetOffset, source->word, sourceOffset);
+
+                if (matchingLength < targetLength && matchingLength < sourceLength) {
+                    return;
+                }
+                if (matchingLength == targetLength && matchingLength == sourceLength) {
+                    subtractNodes(target, source);
+                }
+                else if (matchingLength == targetLength) {
+                    unsigned char next = source->word[sourceOffset + matchingLength];
+                    RadixNode* child = target->children.find(next);
+                    if (child) {
+                        subtractEdge(child, 0, source, sourceOffset + matchingLength);
+                        pruneChild(target, next);
+                        recount(target);
+                    }
+                }
+                else {
+                    const RadixNode* sourceChild = source->children.find(target->word[targetOffset + matchingLength]);
+                    if (sourceChild) {
+                        subtractEdge(target, targetOffset + matchingLength, sourceChild, 0);
+                    }
+                }
+            }
+
+            // Keeps only the words below a target node that are also below a source node spelling the same text.
+            void intersectNodes(RadixNode* target, const RadixNode* source) {
+                target->isEndOfWord = target->isEndOfWord && source->isEndOfWord;
+
+                int after = -1;
+                unsigned char key;
+                while (RadixNode* child = target->children.nextChild(after, key)) {
+                    after = key;
+                    const RadixNode* sourceChild = source->children.find(key);
+                    if (sourceChild) {
+                        intersectEdge(child, 0, sourceChild, 0);
+                        pruneChild(target, key);
+                    }
+                    else {
+                        destroySubtree(target->children.detach(key, pool));
+                    }
+                }
+
+                recount(target);
+            }
+
+            /**
+             * @brief Keeps only the words of a target subtree that are also in a source subtree. Both labels start with the same character.
+             * Emptied nodes below the target are pruned, the target itself is left for its parent to prune.
+             */
+            void intersectEdge(RadixNode* target, size_t targetOffset, const RadixNode* source, size_t sourceOffset) {
+                size_t targetLength = target->word.size() - targetOffset;
+                size_t sourceLength = source->word.size() - sourceOffset;
+                size_t matchingLength = commonPrefixLength(target->word, targetOffset, source->word, sourceOffset);
+
+                if (matchingLength < targetLength && matchingLength < sourceLength) {
+                    clearSubtree(target);
+                }
+                else if (matchingLength == targetLength && matchingLength == sourceLength) {
+                    intersectNodes(target, source);
+                }
+                else if (matchingLength == targetLength) {
+                    // No source word ends here, and only one target child continues along the source label.
+                    unsigned char keep = source->word[sourceOffset + matchingLength];
+                    target->isEndOfWord = false;
+                    int after = -1;
+                    unsigned char key;
+                    while (RadixNode* child = target->children.nextChild(after, key)) {
+                        after = key;
+                        if (key == keep) {
+                            intersectEdge(child, 0, source, sourceOffset + matchingLength);
+                            pruneChild(target, key);
+                        }
+                        else {
+                            destroySubtree(target->children.detach(key, pool));
+                        }
+                    }
+                    recount(target);
+                }
+                else {
+                    const RadixNode* sourceChild = source->children.find(target->word[targetOffset + matchingLength]);
+                    if (sourceChild) {
+                        intersectEdge(target, targetOffset + matchingLength, sourceChild, 0);
+                    }
+                    else {
+                        clearSubtree(target);
+                    }
+                }
+            }
+
+            /**
+             * @brief Copies a subtree into this tree's pool in depth-first order, each node directly followed by its label and child table.
+             * Pass-through nodes are folded into their only child on the way.
+             */
+            RadixNode* copyCompacted(const RadixNode* node) {
+                RadixNode* copy;
+                if (node->isEndOfWord || node->children.size() != 1) {
+                    copy = createNode(node->word.data(), node->word.size());
+                }
+                else {
+                    std::string label;
+                    while (!node->isEndOfWord && node->children.size() == 1) {
+                        label.append(node->word.data(), node->word.size());
+                        node->children.forEach([&](unsigned char, const RadixNode* child) {
+                            node = child;
+                        });
+                    }
+                    label.append(node->word.data(), node->word.size());
+                    copy = createNode(label.data(), label.size());
+                }
+                copyChildrenCompacted(copy, node);
+                return copy;
+            }
+
+            // Gives a copied node the word end marker and count of the original, and compacted copies of its children.
+            void copyChildrenCompacted(RadixNode* copy, const RadixNode* node) {
+                copy->isEndOfWord = node->isEndOfWord;
+                copy->wordCount = node->wordCount;
+                copy->children.reserve(node->children.size(), pool);
+                node->children.forEach([&](unsigned char key, const RadixNode* child) {
+                    copy->children.insert(key, copyCompacted(child), pool);
+                });
+            }
+
+            /**
+             * Parallel operations.
+             * Large trees are split at the root: each root child's subtree is one task, and no two tasks touch the same nodes.
+             * Every thread allocates from a worker tree's pool of its own, so the pools are never shared.
+             */
+
+            // Trees with fewer words than this are copied, merged, subtracted and compared on the calling thread.
+            static constexpr std::uint32_t parallelThreshold = 1 << 16;
+
+            /**
+             * @brief Runs the tasks on up to threadCount threads, the calling one included. A thread takes the next task whenever it finishes one.
+             * @param task Called with the task number and the number of the thread running it.
+             * The first exception a task throws is rethrown once every thread has stopped.
+             */
+            template <typename Task>
+            static void runParallel(size_t taskCount, size_t threadCount, const Task& task) {
+                std::atomic<size_t> next(0);
+                std::exception_ptr failure;
+                std::mutex failureMutex;
+                auto work = [&](size_t worker) {
+                    try {
+                        for (size_t i = next++; i < taskCount; i = next++) {
+                            task(i, worker);
+                        }
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(failureMutex);
+                        if (!failure) {
+                            failure = std::current_exception();
+                        }
+                        next = taskCount;
+                    }
+                };
+
+                std::vector<std::thread> threads;
+                for (size_t worker = 1; worker < threadCount; ++worker) {
+                    try {
+                        threads.emplace_back(work, worker);
+                    }
+                    catch (const std::system_error&) {
+                        // Out of threads: the ones already running share the tasks.
+                        break;
+                    }
+                }
+                work(0);
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                if (failure) {
+                    std::rethrow_exception(failure);
+                }
+            }
+
+            // Number of threads to spread the subtrees of a root over: 1 unless the tree is large and the root branches.
+            static size_t fanOutThreads(const RadixNode* node) {
+                if (node->wordCount < parallelThreshold || node->children.size() < 2) {
+                    return 1;
+                }
+                return std::min(RadixTree::threadCount(), node->children.size());
+            }
+
+            // A node's children, largest subtree first, so that the longest tasks are started early.
+            template <typename Node>
+            static std::vector<std::pair<unsigned char, Node*>> childrenBySize(Node* node) {
+                std::vector<std::pair<unsigned char, Node*>> children;
+                children.reserve(node->children.size());
+                node->children.forEach([&](unsigned char key, Node* child) {
+                    children.emplace_back(key, child);
+                });
+                std::stable_sort(children.begin(), children.end(), [](const auto& first, const auto& second) {
+                    return first.second->wordCount > second.second->wordCount;
+                });
+                return children;
+            }
+
+            // Worker trees for the threads of a parallel operation, in this tree's allocation mode.
+            std::vector<std::unique_ptr<RadixImpl>> makeWorkers(size_t count) const {
+                std::vector<std::unique_ptr<RadixImpl>> workers;
+                for (size_t i = 0; i < count; ++i) {
+                    workers.push_back(std::make_unique<RadixImpl>(pool.isArena()));
+                }
+                return workers;
+            }
+
+            // Keeps the slabs of arena workers, which nodes of this tree now live in, and adds up their counters.
+            void absorbWorkers(std::vector<std::unique_ptr<RadixImpl>>& workers) {
+                for (auto& worker : workers) {
+#ifdef RADIX_TREE_STATS
+                    splits += worker->splits;
+                    merges += worker->merges;
+#endif
+                    if (pool.isArena()) {
+                        donors.push_back(std::move(worker));
+                    }
+                }
+                workers.clear();
+            }
+
+            // copyRadixTree for a large tree: the root's subtrees are copied on separate threads.
+            void copyRootParallel(const RadixNode* otherRoot, size_t threads) {
+                root = createNode("", 0);
+                root->isEndOfWord = otherRoot->isEndOfWord;
+                root->wordCount = otherRoot->wordCount;
+                auto sources = childrenBySize(otherRoot);
+                std::vector<RadixNode*> copies(sources.size());
+                auto workers = makeWorkers(threads);
+                runParallel(sources.size(), threads, [&](size_t task, size_t worker) {
+                    copies[task] = workers[worker]->copyRadixTree(sources[task].second);
+                });
+                root->children.reserve(sources.size(), pool);
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    root->children.insert(sources[i].first, copies[i], pool);
+                }
+                absorbWorkers(workers);
+            }
+
+            // mergeNodes<false> for the roots of large trees: each of the other root's subtrees is merged in on one of the threads.
+            void mergeRootParallel(const RadixImpl& other, size_t threads) {
+                root->isEndOfWord = root->isEndOfWord || other.root->isEndOfWord;
+                auto sources = childrenBySize<const RadixNode>(other.root);
+                // The slots are looked up first, the root's table only changes once the threads are done.
+                std::vector<RadixNode**> slots(sources.size());
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    slots[i] = root->children.findSlot(sources[i].first);
+                }
+                std::vector<RadixNode*> adopted(sources.size(), nullptr);
+                auto workers = makeWorkers(threads);
+                runParallel(sources.size(), threads, [&](size_t task, size_t worker) {
+                    if (slots[task]) {
+                        workers[worker]->mergeEdge<false>(slots[task], other.root, sources[task].first, 0, other);
+                    }
+                    else {
+                        adopted[task] = workers[worker]->copyRadixTree(sources[task].second);
+                    }
+                });
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    if (adopted[i]) {
+                        root->children.insert(sources[i].first, adopted[i], pool);
+                    }
+                }
+                recount(root);
+                absorbWorkers(workers);
+            }
+
+            // subtractNodes for the roots of large heap-mode trees: each subtree of the root is subtracted from on one of the threads.
+            void subtractRootParallel(const RadixNode* sourceRoot, size_t threads) {
+                if (sourceRoot->isEndOfWord) {
+                    root->isEndOfWord = false;
+                }
+                auto sources = childrenBySize(sourceRoot);
+                std::vector<RadixNode*> targets(sources.size());
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    targets[i] = root->children.find(sources[i].first);
+                }
+                auto workers = makeWorkers(threads);
+                runParallel(sources.size(), threads, [&](size_t task, size_t worker) {
+                    if (targets[task]) {
+                        workers[worker]->subtractEdge(targets[task], 0, sources[task].second, 0);
+                    }
+                });
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    if (targets[i]) {
+                        pruneChild(root, sources[i].first);
+                    }
+                }
+                recount(root);
+                absorbWorkers(workers);
+            }
+
+            // compareTrees for the roots of large trees: pairs of subtrees are compared on separate threads until one differs.
+            bool compareRootsParallel(const RadixNode* otherRoot, size_t threads) const {
+                if (root->isEndOfWord != otherRoot->isEndOfWord || root->children.size() != otherRoot->children.size()) {
+                    return false;
+                }
+                auto children = childrenBySize<const RadixNode>(root);
+                std::atomic<bool> equal(true);
+                runParallel(children.size(), threads, [&](size_t task, size_t) {
+                    if (!equal.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const RadixNode* matchingChild = otherRoot->children.find(children[task].first);
+                    if (!matchingChild || !compareTrees(children[task].second, matchingChild)) {
+                        equal.store(false, std::memory_order_relaxed);
+                    }
+                });
+                return equal;
+            }
+
+            /**
+             * @brief Builds a tree from words in any order on several threads, see RadixTree::buildParallel.
+             */
+            template <typename Word>
+            static RadixTree buildParallel(const std::vector<Word>& words, size_t threads, AllocationMode mode) {
+                // Words are grouped by their first two bytes; shorter words get groups of their own.
+                static constexpr size_t groupCount = 1 + 256 + 256 * 256;
+                auto groupOf = [](std::string_view word) -> size_t {
+                    if (word.size() < 2) {
+                        return word.empty() ? 0 : 1 + static_cast<unsigned char>(word[0]);
+                    }
+                    return 257 + static_cast<unsigned char>(word[0]) * 256 + static_cast<unsigned char>(word[1]);
+                };
+
+                // Counting sort of the word positions by group.
+                std::vector<size_t> groupStart(groupCount + 1, 0);
+                for (const auto& word : words) {
+                    ++groupStart[groupOf(word) + 1];
+                }
+                for (size_t group = 0; group < groupCount; ++group) {
+                    groupStart[group + 1] += groupStart[group];
+                }
+                std::vector<size_t> order(words.size());
+                std::vector<size_t> filled(groupStart.begin(), groupStart.end() - 1);
+                for (size_t i = 0; i < words.size(); ++i) {
+                    order[filled[groupOf(words[i])]++] = i;
+                }
+
+                std::vector<size_t> groups;
+                for (size_t group = 0; group < groupCount; ++group) {
+                    if (groupStart[group + 1] > groupStart[group]) {
+                        groups.push_back(group);
+                    }
+                }
+                std::stable_sort(groups.begin(), groups.end(), [&](size_t first, size_t second) {
+                    return groupStart[first + 1] - groupStart[first] > groupStart[second + 1] - groupStart[second];
+                });
+
+                threads = std::max<size_t>(1, std::min(threads ? threads : RadixTree::threadCount(), groups.size()));
+                std::vector<RadixTree> parts;
+                parts.reserve(threads);
+                for (size_t i = 0; i < threads; ++i) {
+                    parts.emplace_back(mode);
+                }
+                runParallel(groups.size(), threads, [&](size_t task, size_t worker) {
+                    for (size_t i = groupStart[groups[task]]; i < groupStart[groups[task] + 1]; ++i) {
+                        parts[worker].insert(words[order[i]]);
+                    }
+                });
+
+                // Groups never share a word, so the parts only overlap in the nodes spelling a first byte.
+                RadixTree tree(mode);
+                for (auto& part : parts) {
+                    tree.merge(std::move(part));
+                }
+                return tree;
+            }
+
+            /**
+             * @class WordLoader
+             * @brief Splits input into words and adds them to a tree, see RadixTree::loadFrom.
+             * Input arrives in chunks; what follows the last delimiter of a chunk is handed back to be completed by the next one.
+             * While the tree was empty and the words keep ascending, they go to a Builder, which takes over the tree at the end.
+             */
+            class WordLoader {
+                private:
+                    RadixTree& tree;
+                    const LoadOptions& options;
+                    LoadStatistics statistics;
+                    Builder builder;
+                    bool building;
+                    ValueType previous; // Last word given to the builder.
+                    bool hasPrevious = false;
+
+                    // Hands the words built so far over to the tree, later words are inserted one by one.
+                    void stopBuilding() {
+                        if (building) {
+                            bool indexed = tree.hasSuffixIndex();
+                            tree = builder.finish();
+                            tree.setSuffixIndex(indexed);
+                            building = false;
+                        }
+                    }
+
+                    void countDuplicate() {
+                        ++statistics.duplicates;
+                        if (!options.skipDuplicates) {
+                            stopBuilding();
+                            throw MyException("The word already exists in the tree");
+                        }
+                    }
+
+                    void add(std::string_view word) {
+                        if (options.trimCarriageReturns && !word.empty() && word.back() == '\r') {
+                            word.remove_suffix(1);
+                        }
+                        if (word.empty() && options.skipEmpty) {
+                            return;
+                        }
+
+                        if (building) {
+                            // string_view compares bytes as unsigned, the same order the builder and the tree use.
+                            int order = hasPrevious ? word.compare(previous) : 1;
+                            if (order > 0) {
+                                builder.add(word);
+                                previous.assign(word);
+                                hasPrevious = true;
+                                ++statistics.added;
+                                return;
+                            }
+                            if (order == 0) {
+                                countDuplicate();
+                                return;
+                            }
+                            statistics.sorted = false;
+                            stopBuilding();
+                        }
+
+                        if (tree.impl().insertWord(word)) {
+                            ++statistics.added;
+                        }
+                        else {
+                            countDuplicate();
+                        }
+                    }
+
+                public:
+                    WordLoader(RadixTree& target, const LoadOptions& loadOptions)
+                        : tree(target), options(loadOptions), builder(target.isArena() ? AllocationMode::Arena : AllocationMode::Heap), building(target.empty()) {
+                        // Words loaded into a tree that already has some are inserted one by one, whatever their order.
+                        statistics.sorted = building;
+                    }
+
+                    /**
+                     * @brief Adds the words of a chunk.
+                     * @param last Whether the input ends with this chunk, so that its end also ends a word.
+                     * @return Number of bytes used; the rest is the start of a word that goes on in the next chunk.
+                     */
+                    size_t feed(const char* data, size_t length, bool last) {
+                        const char* position = data;
+                        const char* end = data + length;
+                        while (position < end) {
+                            const char* delimiter = static_cast<const char*>(std::memchr(position, options.delimiter, end - position));
+                            if (!delimiter) {
+                                if (!last) {
+                                    break;
+                                }
+                                delimiter = end;
+                            }
+                            add(std::string_view(position, delimiter - position));
+                            position = delimiter == end ? end : delimiter + 1;
+                        }
+                        statistics.bytes += position - data;
+                        return position - data;
+                    }
+
+                    /**
+                     * @brief Feeds everything a read function returns, in chunks of options.bufferSize bytes.
+                     * @param read Called with a buffer and its size, returns the number of bytes it stored, 0 at the end of the input.
+                     */
+                    template <typename Read>
+                    void readChunks(Read&& read) {
+                        std::vector<char> buffer(std::max<size_t>(options.bufferSize, 1));
+                        size_t pending = 0;
+                        while (true) {
+                            // A word longer than the whole buffer.
+                            if (pending == buffer.size()) {
+                                buffer.resize(buffer.size() * 2);
+                            }
+                            size_t count = read(buffer.data() + pending, buffer.size() - pending);
+                            size_t used = feed(buffer.data(), pending + count, count == 0);
+                            if (count == 0) {
+                                return;
+                            }
+                            pending += count - used;
+                            std::memmove(buffer.data(), buffer.data() + used, pending);
+                        }
+                    }
+
+                    LoadStatistics finish() {
+                        stopBuilding();
+                        return statistics;
+                    }
+            };
+
+            // Replaces the contents of this tree with a copy of another tree.
+            void copyFrom(const RadixImpl& other) {
+                deleteTree();
+                size_t threads = fanOutThreads(other.root);
+                if (threads > 1) {
+                    copyRootParallel(other.root, threads);
+                }
+                else {
+                    root = copyRadixTree(other.root);
+                }
+                // The suffix index goes along with the words.
+                reversed = other.reversed ? std::make_unique<RadixTree>(*other.reversed) : nullptr;
+            }
+
+            // Clears the radix tree.
+            void emptyTree() {
+                deleteTree();
+                root = createNode("", 0);
+                if (reversed) {
+                    reversed->pImpl->emptyTree();
+                }
+            }
+
+            /**
+             * @brief Deletes the radix tree.
+             * An arena-backed tree drops its slabs instead of visiting every node.
+             */
+            void deleteTree() {
+                if (pool.isArena()) {
+                    pool.release();
+                    donors.clear();
+                }
+                else {
+                    destroySubtree(root);
+                }
+                root = nullptr;
+            }
+    };
+
+    // Constructor.
+    RadixTree::RadixTree() : pImpl(std::make_unique<RadixImpl>()) {
+                
+    }
+
+    RadixTree::RadixTree(AllocationMode mode) : pImpl(std::make_unique<RadixImpl>(mode == AllocationMode::Arena)) {
+
+    }
+
+    // Destructor.
+    RadixTree::~RadixTree() = default;
+
+    // Deep copy constructor.
+    RadixTree::RadixTree(const RadixTree& other) : pImpl(std::make_unique<RadixImpl>(other.isArena())) {
+        pImpl->copyFrom(other.impl());
+    }
+
+    RadixTree& RadixTree::operator=(const RadixTree& other) {
+        if (this != &other) {
+            impl().copyFrom(other.impl());
+        }
+        return *this;
+    }
+
+    // The other tree is left without an implementation, so moving never allocates. It is created again once the tree is changed.
+    RadixTree::RadixTree(RadixTree&& other) noexcept : pImpl(std::move(other.pImpl)), arenaAfterMove(other.arenaAfterMove) {
+        other.arenaAfterMove = isArena();
+    }
+
+    RadixTree& RadixTree::operator=(RadixTree&& other) noexcept {
+        if (this != &other) {
+            pImpl = std::move(other.pImpl);
+            arenaAfterMove = other.arenaAfterMove;
+            other.arenaAfterMove = isArena();
+        }
+        return *this;
+    }
+
+    RadixTree::RadixImpl& RadixTree::impl() {
+        if (!pImpl) {
+            pImpl = std::make_unique<RadixImpl>(arenaAfterMove);
+        }
+        return *pImpl;
+    }
+
+    const RadixTree::RadixImpl& RadixTree::impl() const {
+        static const RadixImpl emptyImpl;
+        return pImpl ? *pImpl : emptyImpl;
+    }
+
+    bool RadixTree::isArena() const {
+        return pImpl ? pImpl->pool.isArena() : arenaAfterMove;
+    }
+
+    class RadixTree::Builder::BuilderImpl {
+        public:
+            /**
+             * @brief A node on the path to the most recently added word.
+             */
+            struct Frame {
+                RadixImpl::RadixNode* node;
+                size_t depth; // Length of the word prefix spelled out up to the end of this node's label.
+            };
+
+            AllocationMode mode;
+            RadixTree tree;
+            std::vector<Frame> path;
+            ValueType previous;
+            bool hasPrevious;
+
+            explicit BuilderImpl(AllocationMode allocationMode) : mode(allocationMode), tree(allocationMode), hasPrevious(false) {
+                path.push_back({tree.pImpl->root, 0});
+            }
+
+            void add(std::string_view word) {
+                size_t common = 0;
+                while (common < previous.size() && common < word.size() && previous[common] == word[common]) {
+                    ++common;
+                }
+
+                // The first differing character (or the end of the new word) tells whether the words are in order.
+                if (hasPrevious) {
+                    if (common == word.size() && common == previous.size()) {
+                        throw MyException("The word already exists in the tree");
+                    }
+                    if (common == word.size() || (common < previous.size() && static_cast<unsigned char>(word[common]) < static_cast<unsigned char>(previous[common]))) {
+                        throw MyException("Words must be added in ascending order");
+                    }
+                }
+
+                /**
+                 * Close every node that lies entirely below the common prefix.
+                 * If the common prefix ends in the middle of a node's label, that node is the latest child
+                 * of its parent, so it is split right there without searching for it.
+                 */
+                RadixImpl& impl = *tree.pImpl;
+                while (path.back().depth > common) {
+                    Frame top = path.back();
+                    const Frame& parent = path[path.size() - 2];
+                    if (parent.depth >= common) {
+                        path.pop_back();
+                        continue;
+                    }
+
+                    size_t cut = common - parent.depth;
+                    RadixImpl::RadixNode* nodeSplit = impl.createNode(top.node->word.data(), cut);
+                    nodeSplit->wordCount = top.node->wordCount;
+                    top.node->word.erase(0, cut);
+                    *parent.node->children.findSlot(nodeSplit->word[0]) = nodeSplit;
+                    nodeSplit->children.insert(top.node->word[0], top.node, impl.pool);
+                    path.back() = {nodeSplit, common};
+                }
+
+                for (const Frame& frame : path) {
+                    ++frame.node->wordCount;
+                }
+
+                // Only the very first word can end exactly at the common prefix, that is the empty word.
+                if (common == word.size()) {
+                    path.back().node->isEndOfWord = true;
+                }
+                else {
+                    RadixImpl::RadixNode* leaf = impl.createNode(word.data() + common, word.size() - common);
+                    leaf->isEndOfWord = true;
+                    leaf->wordCount = 1;
+                    path.back().node->children.insert(word[common], leaf, impl.pool);
+                    path.push_back({leaf, word.size()});
+                }
+
+                previous.assign(word);
+                hasPrevious = true;
+            }
+    };
 
-                /**
-                 * @brief Constructs an empty radix tree node.
-                 * @param wrd The word (prefix) to be saved at the current node.
-                 * By default isEndOfWord marker is assigned to false,
-                 * as the program will determine whether this is trule the end of a word later.
-                 */
-                RadixNode(const ValueType& wrd = "") : word(wrd), isEndOfWord(false) {
+    RadixTree::Builder::Builder(AllocationMode mode) : pImpl(std::make_unique<BuilderImpl>(mode)) {
 
-                };
-            };
+    }
 
-            /**
-             * @brief Constructor that automatically craetes a root node.
-             */
-            std::unique_ptr<RadixNode> root;
-            RadixImpl() : root(std::make_unique<RadixNode>()) {
+    RadixTree::Builder::~Builder() = default;
 
-            }
+    void RadixTree::Builder::add(std::string_view word) {
+        pImpl->add(word);
+    }
 
-            /**
-             * @brief Destructor that frees any alocated memory.
-             */
-            ~RadixImpl() {
-                deleteTree();
-            }
+    RadixTree RadixTree::Builder::finish() {
+        RadixTree built = std::move(pImpl->tree);
+        pImpl = std::make_unique<BuilderImpl>(pImpl->mode);
+        return built;
+    }
 
+    class RadixTree::ConstIterator::IteratorImpl {
+        public:
             /**
-             * @brief Collects all words saved in the radix tree.
+             * @brief A node on the path to the current word.
              */
-            void collectAllWords(const RadixNode* currentNode, ValueType prefix, std::vector<ValueType>& allWords) const {
-                if (!currentNode) {
-                    return;
-                }
+            struct Frame {
+                const RadixImpl::RadixNode* node;
+                int lastKey; // Key of the child visited last, -1 before the first one.
+                size_t bufferLength; // Length of the word buffer before this node's label was appended.
+            };
 
-                prefix += currentNode->word;
-                if (currentNode->isEndOfWord) {
-                    allWords.push_back(prefix);
-                }
+            std::vector<Frame> stack;
+            ValueType word;
 
-                for (const auto& [character, child] : currentNode->children) {
-                    collectAllWords(child.get(), prefix, allWords);
+            /**
+             * @brief Positions the iterator on the first word of a subtree.
+             * @param start Root of the subtree to visit.
+             * @param prefix The text spelled out by the path above the subtree's root.
+             */
+            IteratorImpl(const RadixImpl::RadixNode* start, ValueType prefix) : word(std::move(prefix)) {
+                stack.push_back({start, -1, word.size()});
+                word.append(start->word.data(), start->word.size());
+                if (!start->isEndOfWord) {
+                    advance();
                 }
             }
 
             /**
-             * @brief Compares if trees are equal (have the same saved words).
-             * @param thisNode Current node.
-             * @param otherNode Node to compare with.
-             * @return True if they are equal, false otherwise.
+             * @brief Moves to the next node marking the end of a word, in depth-first (lexicographic) order.
+             * Leaves the stack empty once every word has been visited.
              */
-            bool compareTrees(const RadixNode* thisNode, const RadixNode* otherNode) const {
-                if (!thisNode && !otherNode) {
-                    return true;
-                }
-                if (!thisNode || !otherNode) {
-                    return false;
-                }
-
-                if (thisNode->word != otherNode->word || thisNode->isEndOfWord != otherNode->isEndOfWord || thisNode->children.size() != otherNode->children.size()) {
-                    return false;
-                }
-
-                for (const auto& [thisNodesChar, thisNodesChild] : thisNode->children) {
-                    auto matchingChild = otherNode->children.find(thisNodesChar);
-                    if (matchingChild == otherNode->children.end()) {
-                        return false;
+            void advance() {
+                while (!stack.empty()) {
+                    Frame& top = stack.back();
+                    unsigned char key;
+                    const RadixImpl::RadixNode* child = top.node->children.nextChild(top.lastKey, key);
+                    if (!child) {
+                        word.resize(top.bufferLength);
+                        stack.pop_back();
+                        continue;
                     }
 
-                    if (!compareTrees(thisNodesChild.get(), matchingChild->second.get())) {
-                        return false;
+                    top.lastKey = key;
+                    stack.push_back({child, -1, word.size()});
+                    word.append(child->word.data(), child->word.size());
+                    if (child->isEndOfWord) {
+                        return;
                     }
                 }
-
-                return true;
-            }
-
-            static std::unique_ptr<RadixNode> copyRadixTree(const RadixNode* node) {
-                if (!node) {
-                    return nullptr;
-                }
-                auto copy = std::make_unique<RadixNode>(node->word);
-                copy->isEndOfWord = node->isEndOfWord;
-                for (const auto& ptr : node->children) {
-                    copy->children[ptr.first] = copyRadixTree(ptr.second.get());
-                }
-                return copy;
             }
 
-            // Clears the radix tree.
-            void emptyTree() {
-                root = std::make_unique<RadixNode>();
-            }
-
-            // Deletes the radix tree.
-            void deleteTree() {
-                root.reset();
+            bool atEnd() const {
+                return stack.empty();
             }
     };
 
-    // Constructor.
-    RadixTree::RadixTree() : pImpl(std::make_unique<RadixImpl>()) {
-                
-    }
+    RadixTree::ConstIterator::ConstIterator() = default;
 
-    // Destructor.
-    RadixTree::~RadixTree() = default;
+    RadixTree::ConstIterator::~ConstIterator() = default;
+
+    RadixTree::ConstIterator::ConstIterator(const ConstIterator& other) : pImpl(other.pImpl ? std::make_unique<IteratorImpl>(*other.pImpl) : nullptr) {
 
-    // Deep copy constructor.
-    RadixTree::RadixTree(const RadixTree& other) : pImpl(std::make_unique<RadixImpl>()) {
-        pImpl->root = RadixImpl::copyRadixTree(other.pImpl->root.get());
     }
 
-    RadixTree& RadixTree::operator=(const RadixTree& other) {
+    RadixTree::ConstIterator& RadixTree::ConstIterator::operator=(const ConstIterator& other) {
         if (this != &other) {
-            pImpl = std::make_unique<RadixImpl>();
-            pImpl->root = RadixImpl::copyRadixTree(other.pImpl->root.get());
+            pImpl = other.pImpl ? std::make_unique<IteratorImpl>(*other.pImpl) : nullptr;
         }
         return *this;
     }
 
-    void RadixTree::insert(const ValueType& word) {
-        RadixImpl::RadixNode* node = pImpl->root.get();
-        size_t index = 0;
+    RadixTree::ConstIterator::ConstIterator(ConstIterator&& other) noexcept = default;
 
-        while (index < word.size()) {
-            char c = word[index];
-            /**
-             * Create a child node if none exists matching the prefix.
-             * Place the prefix into the child node.
-            */
-            if (node->children.count(c) == 0) {
-                node->children[c] = std::make_unique<RadixImpl::RadixNode>(word.substr(index));
-                node->children[c]->isEndOfWord = true;
-                return;
-            }
+    RadixTree::ConstIterator& RadixTree::ConstIterator::operator=(ConstIterator&& other) noexcept = default;
 
-            RadixImpl::RadixNode* child = node->children[c].get();
-            size_t matchingLength = 0;
-            // Check to see how much of the prefix matches.
-            while (matchingLength < child->word.size() && index + matchingLength < word.size() && word[index + matchingLength] == child->word[matchingLength]) {
-                ++matchingLength;
-            }
-            // If the entire child's prefix matches, move to it.
-            if (matchingLength == child->word.size()) {
-                node = child;
-                index += matchingLength;
-            }
-            /**
-             * Else, split the node, look for how long the two match,
-             * once they don't match, save the matching part as the new prefix for the child,
-             * place the rest of child's prefix into a grandchild node,
-             * and create another grandchild, placing the prefix there.
-             */
-            else {
-                auto nodeSplit = std::make_unique<RadixImpl::RadixNode>(child->word.substr(0, matchingLength));
-                nodeSplit->children[child->word[matchingLength]] = std::move(node->children[c]);
-                nodeSplit->children[child->word[matchingLength]]->word = child->word.substr(matchingLength);
-                nodeSplit->isEndOfWord = false;
-                node->children[c] = std::move(nodeSplit);
+    RadixTree::ConstIterator::reference RadixTree::ConstIterator::operator*() const {
+        return pImpl->word;
+    }
 
-                if (index + matchingLength < word.size()) {
-                    node->children[c]->children[word[index + matchingLength]] = std::make_unique<RadixImpl::RadixNode>(word.substr(index + matchingLength));
-                    node->children[c]->children[word[index + matchingLength]]->isEndOfWord = true;
-                }
-                else {
-                    node->children[c]->isEndOfWord = true;
-                }
-                return;
-            }
+    RadixTree::ConstIterator::pointer RadixTree::ConstIterator::operator->() const {
+        return &pImpl->word;
+    }
+
+    RadixTree::ConstIterator& RadixTree::ConstIterator::operator++() {
+        pImpl->advance();
+        return *this;
+    }
+
+    RadixTree::ConstIterator RadixTree::ConstIterator::operator++(int) {
+        ConstIterator previous(*this);
+        pImpl->advance();
+        return previous;
+    }
+
+    bool RadixTree::ConstIterator::operator==(const ConstIterator& other) const {
+        bool thisAtEnd = !pImpl || pImpl->atEnd();
+        bool otherAtEnd = !other.pImpl || other.pImpl->atEnd();
+        if (thisAtEnd || otherAtEnd) {
+            return thisAtEnd == otherAtEnd;
         }
-        
+        return pImpl->stack.back().node == other.pImpl->stack.back().node;
+    }
+
+    bool RadixTree::ConstIterator::operator!=(const ConstIterator& other) const {
+        return !(*this == other);
+    }
+
+    RadixTree::ConstIterator RadixTree::begin() const {
+        ConstIterator iterator;
+        iterator.pImpl = std::make_unique<ConstIterator::IteratorImpl>(impl().root, ValueType());
+        return iterator;
+    }
+
+    RadixTree::ConstIterator RadixTree::end() const {
+        return ConstIterator();
+    }
+
+    void RadixTree::insert(std::string_view word) {
+        RADIX_STATS_TIME(Insert);
         // If the word already exists, throw an exception.
-        if (node->isEndOfWord == true) {
+        if (!impl().insertWord(word)) {
             throw MyException("The word already exists in the tree");
         }
-        // Else mark the current node as the end of the word.
-        else {
-            node->isEndOfWord = true;
-        }
     }
 
-    bool RadixTree::search(const ValueType& word) const{
-        const RadixImpl::RadixNode* node = pImpl->root.get();
+    bool RadixTree::search(std::string_view word) const{
+        RADIX_STATS_TIME(Search);
+        const RadixImpl::RadixNode* node = impl().root;
         size_t index = 0;
 
         while (index < word.size()) {
-            char c = word[index];
-
             // If the current node doesn't have matching children, return false.
-            if (node->children.count(c) == 0)
-            {
+            const RadixImpl::RadixNode* child = node->children.find(word[index]);
+            if (!child) {
                 return false;
             }
 
-            const RadixImpl::RadixNode* child = node->children.at(c).get();
-            size_t matchingLength = 0;
-
             // Check for how long the prefixes match.
-            while (matchingLength < child->word.size() && index + matchingLength < word.size() && word[index + matchingLength] == child->word[matchingLength]) {
-                ++matchingLength;
-            }
+            size_t matchingLength = PrefixMatch::commonPrefixLength(child->word.data(), word.data() + index, std::min<size_t>(child->word.size(), word.size() - index));
             // If the length doesn't match (meaning the word is shorter than the child prefix), return false.
             if (matchingLength != child->word.size()) {
                 return false;
@@ -229,77 +2553,273 @@ namespace RadixTreeProject {
         return node->isEndOfWord;
     }
 
-    void RadixTree::remove(const ValueType& word) {
-        RadixImpl::RadixNode* node = pImpl->root.get();
-        std::vector<std::pair<RadixImpl::RadixNode*, char>> removablePart;
-        size_t index = 0;
+    RadixTree::LoadStatistics RadixTree::loadFrom(const std::string& path, const LoadOptions& options) {
+        RadixImpl::WordLoader loader(*this, options);
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw MyException("Couldn't open " + path);
+        }
+        loader.readChunks([&](char* buffer, size_t size) {
+            file.read(buffer, static_cast<std::streamsize>(size));
+            if (file.bad()) {
+                throw MyException("Couldn't read " + path);
+            }
+            return static_cast<size_t>(file.gcount());
+        });
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw MyException("Couldn't open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            size_t length = static_cast<size_t>(info.st_size);
+            void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapping == MAP_FAILED) {
+                throw MyException("Couldn't map " + path);
+            }
+            // Unmaps the file however loading ends, a duplicate's exception included.
+            struct Mapping {
+                void* data;
+                size_t length;
+                ~Mapping() {
+                    ::munmap(data, length);
+                }
+            } guard{mapping, length};
+            ::madvise(mapping, length, MADV_SEQUENTIAL);
+            loader.feed(static_cast<const char*>(mapping), length, true);
+        }
+        else {
+            // Pipes, terminals and the like can't be mapped, they're read in chunks.
+            struct Descriptor {
+                int fd;
+                ~Descriptor() {
+                    ::close(fd);
+                }
+            } guard{fd};
+            loader.readChunks([&](char* buffer, size_t size) {
+                ssize_t count;
+                do {
+                    count = ::read(fd, buffer, size);
+                } while (count < 0 && errno == EINTR);
+                if (count < 0) {
+                    throw MyException("Couldn't read " + path);
+                }
+                return static_cast<size_t>(count);
+            });
+        }
+#endif
+        return loader.finish();
+    }
+
+    RadixTree::LoadStatistics RadixTree::loadFrom(const std::string& path) {
+        return loadFrom(path, LoadOptions());
+    }
 
-        while (node && index < word.size()) {
-            char c = word[index];
-            // If the child with matching prefix doesn't exist, throw exception.
-            auto existingChild = node->children.find(c);
-            if (existingChild == node->children.end()) {
-                throw MyException("Word not found. Couldn't remove");
+    RadixTree::LoadStatistics RadixTree::loadFrom(std::istream& input, const LoadOptions& options) {
+        RadixImpl::WordLoader loader(*this, options);
+        loader.readChunks([&](char* buffer, size_t size) {
+            input.read(buffer, static_cast<std::streamsize>(size));
+            if (input.bad()) {
+                throw MyException("Couldn't read from the stream");
             }
+            return static_cast<size_t>(input.gcount());
+        });
+        return loader.finish();
+    }
 
-            RadixImpl::RadixNode* child = existingChild->second.get();
-            size_t matchingLength = 0;
+    RadixTree::LoadStatistics RadixTree::loadFrom(std::istream& input) {
+        return loadFrom(input, LoadOptions());
+    }
 
-            // Check for how long the prefixes match.
-            while (matchingLength < child->word.size() && index + matchingLength < word.size() && word[index + matchingLength] == child->word[matchingLength]) {
-                ++matchingLength;
+    RadixTree RadixTree::buildParallel(const std::vector<ValueType>& words, size_t threads, AllocationMode mode) {
+        return RadixImpl::buildParallel(words, threads, mode);
+    }
+
+    RadixTree RadixTree::buildParallel(const std::vector<std::string_view>& words, size_t threads, AllocationMode mode) {
+        return RadixImpl::buildParallel(words, threads, mode);
+    }
+
+    void RadixTree::setThreadCount(size_t threads) {
+        configuredThreads = threads;
+    }
+
+    size_t RadixTree::threadCount() {
+        size_t threads = configuredThreads;
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::optional<std::string_view> RadixTree::longestPrefixOf(std::string_view text) const {
+        const RadixImpl::RadixNode* node = impl().root;
+        size_t index = 0;
+        std::optional<std::string_view> longest;
+        if (node->isEndOfWord) {
+            longest = text.substr(0, 0);
+        }
+
+        // The descent of search, remembering the last node on the way where a word ends.
+        while (index < text.size()) {
+            const RadixImpl::RadixNode* child = node->children.find(text[index]);
+            if (!child || child->word.size() > text.size() - index ||
+                PrefixMatch::commonPrefixLength(child->word.data(), text.data() + index, child->word.size()) != child->word.size()) {
+                break;
             }
-            // If the length doesn't match (meaning the word is shorter than the child prefix), throw exception.
-            if (matchingLength != child->word.size()) {
-                throw MyException("Word not found. Couldn't remove");
+            node = child;
+            index += child->word.size();
+            if (node->isEndOfWord) {
+                longest = text.substr(0, index);
             }
+        }
+        return longest;
+    }
 
-            // Save how much of the tree will be deleted.
-            removablePart.emplace_back(node, c);
-            node = child;
-            index += matchingLength;
+    void RadixTree::setSuffixIndex(bool enabled) {
+        if (!enabled) {
+            impl().reversed.reset();
+        }
+        else if (!impl().reversed) {
+            impl().reversed = std::make_unique<RadixTree>(impl().buildReversed());
         }
+    }
 
-        /**
-         * If:
-         * 1) node is null,
-         * 2) current node's prefix isn't marked as an end of a word OR,
-         * 3) index doesn't match the length of the word,
-         * throw exception.
-         */
-        if (!node || !node->isEndOfWord || index != word.size()) {
+    bool RadixTree::hasSuffixIndex() const {
+        return impl().reversed != nullptr;
+    }
+
+    size_t RadixTree::endsWith(std::string_view suffix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        if (!impl().reversed) {
+            throw MyException("endsWith needs the suffix index, see setSuffixIndex");
+        }
+        return impl().reversed->forEachWithPrefix(RadixImpl::reverse(suffix), [&](const ValueType& reversedWord) {
+            callback(RadixImpl::reverse(reversedWord));
+        }, limit);
+    }
+
+    void RadixTree::searchBatch(const std::vector<ValueType>& words, std::vector<bool>& found) const {
+        impl().searchBatch(words, found);
+    }
+
+    void RadixTree::searchBatch(const std::vector<std::string_view>& words, std::vector<bool>& found) const {
+        impl().searchBatch(words, found);
+    }
+
+    bool RadixTree::hasPrefix(std::string_view prefix) const {
+        return countWithPrefix(prefix) > 0;
+    }
+
+    size_t RadixTree::countWithPrefix(std::string_view prefix) const {
+        size_t labelStart;
+        const RadixImpl::RadixNode* node = impl().findPrefixNode(prefix, labelStart);
+        return node ? node->wordCount : 0;
+    }
+
+    size_t RadixTree::forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        size_t labelStart;
+        const RadixImpl::RadixNode* node = impl().findPrefixNode(prefix, labelStart);
+        if (!node || limit == 0) {
+            return 0;
+        }
+
+        // Only the subtree below the prefix is walked, starting with the whole label of the node the prefix ends in.
+        ConstIterator::IteratorImpl position(node, ValueType(prefix.substr(0, labelStart)));
+        size_t reported = 0;
+        while (!position.atEnd() && reported < limit) {
+            callback(position.word);
+            ++reported;
+            position.advance();
+        }
+        return reported;
+    }
+
+    std::vector<std::pair<RadixTree::ValueType, size_t>> RadixTree::searchWithin(std::string_view word, size_t maxDistance, size_t limit) const {
+        std::vector<std::pair<ValueType, size_t>> matches;
+        if (limit == 0) {
+            return matches;
+        }
+
+        RadixImpl::FuzzySearch search{word, std::min(maxDistance, RadixImpl::FuzzySearch::unlimited), limit, ValueType(), std::vector<size_t>(word.size() + 1), {}};
+        // The empty path is as far from every prefix of the word as that prefix is long.
+        for (size_t j = 0; j <= word.size(); ++j) {
+            search.rows[j] = j;
+        }
+        RadixImpl::fuzzyWalk(impl().root, 0, search);
+
+        std::sort_heap(search.best.begin(), search.best.end());
+        matches.reserve(search.best.size());
+        for (auto& [distance, match] : search.best) {
+            matches.emplace_back(std::move(match), distance);
+        }
+        return matches;
+    }
+
+    size_t RadixTree::match(std::string_view pattern, const std::function<void(const ValueType&)>& callback, size_t limit) const {
+        RadixImpl::GlobPattern compiled(pattern);
+        if (limit == 0) {
+            return 0;
+        }
+
+        RadixImpl::GlobMatch match{compiled, callback, limit, 0, ValueType(), std::vector<unsigned char>(compiled.count() + 1)};
+        match.states[0] = 1;
+        match.close(match.states.data());
+        RadixImpl::globWalk(impl().root, 0, match);
+        return match.reported;
+    }
+
+    void RadixTree::remove(std::string_view word) {
+        RADIX_STATS_TIME(Remove);
+        // If the word doesn't exist, throw an exception.
+        if (!impl().removeWord(word)) {
             throw MyException("Word not found. Couldn't remove");
         }
+    }
+
+    bool RadixTree::tryInsert(std::string_view word) {
+        RADIX_STATS_TIME(Insert);
+        return impl().insertWord(word);
+    }
 
-        // Remove this prefix as the end of the word.
-        node->isEndOfWord = false;
+    bool RadixTree::tryRemove(std::string_view word) {
+        RADIX_STATS_TIME(Remove);
+        return impl().removeWord(word);
+    }
 
-        /**
-         * Iterate backwards through the nodes (leaf to root),
-         * checking to see if the child isn't marked as a word ending,
-         * and doesn't have children.
-         * If not - deletes it, else - breaks the cycle.
-         */
-        for (int i = removablePart.size() - 1; i >= 0; --i) {
-            RadixImpl::RadixNode* parent = removablePart[i].first;
-            char c = removablePart[i].second;
-            RadixImpl::RadixNode* child = parent->children[c].get();
+    size_t RadixTree::insertBatch(const std::vector<ValueType>& words) {
+        return impl().insertBatch(words);
+    }
 
-            if (!child->isEndOfWord && child->children.empty()) {
-                parent->children.erase(c);
-            }
-            else {
-                break;
-            }
+    size_t RadixTree::insertBatch(const std::vector<std::string_view>& words) {
+        return impl().insertBatch(words);
+    }
+
+    size_t RadixTree::removeBatch(const std::vector<ValueType>& words) {
+        return impl().removeBatch(words);
+    }
+
+    size_t RadixTree::removeBatch(const std::vector<std::string_view>& words) {
+        return impl().removeBatch(words);
+    }
+
+    void RadixTree::compact() {
+        // The copy is built in a fresh pool in depth-first order. Arena nodes end up in one run of slabs, heap nodes wherever the allocator puts them.
+        auto compacted = std::make_unique<RadixImpl>(impl().pool.isArena());
+        compacted->copyChildrenCompacted(compacted->root, impl().root);
+#ifdef RADIX_TREE_STATS
+        compacted->splits = impl().splits;
+        compacted->merges = impl().merges;
+#endif
+        compacted->reversed = std::move(impl().reversed);
+        if (compacted->reversed) {
+            compacted->reversed->compact();
         }
+        pImpl = std::move(compacted);
     }
 
     std::string RadixTree::toString() const {
-        std::vector<ValueType> allSavedWords;
-        pImpl->collectAllWords(pImpl->root.get(), "", allSavedWords);
         std::ostringstream os;
 
-        for (const ValueType& currentWord : allSavedWords) {
+        for (const ValueType& currentWord : *this) {
             os << currentWord << ", ";
 
         }
@@ -307,8 +2827,134 @@ namespace RadixTreeProject {
         return os.str();
     }
 
+    FrozenRadixTree RadixTree::freeze() const {
+        // Nodes are laid out breadth-first, so the children of every node are consecutive edges.
+        Succinct::LoudsTree layout;
+        layout.rootIsEndOfWord = impl().root->isEndOfWord;
+        layout.wordCount = impl().root->wordCount;
+        std::vector<const RadixImpl::RadixNode*> queue = {impl().root};
+        for (size_t i = 0; i < queue.size(); ++i) {
+            bool firstChild = true;
+            queue[i]->children.forEach([&](unsigned char, const RadixImpl::RadixNode* child) {
+                layout.addEdge(child->word.data(), child->word.size(), firstChild, !child->children.empty(), child->isEndOfWord);
+                firstChild = false;
+                if (!child->children.empty()) {
+                    queue.push_back(child);
+                }
+            });
+        }
+        layout.finish();
+        return FrozenRadixTree(std::move(layout));
+    }
+
+    void RadixTree::save(const std::string& path) const {
+        // Lay the nodes out breadth-first, so that the children of every node end up next to each other.
+        std::vector<const RadixImpl::RadixNode*> order;
+        order.push_back(impl().root);
+        std::vector<RadixFormat::FileNode> fileNodes;
+        std::uint64_t labelBytes = 0;
+        std::uint64_t wordCount = 0;
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            const RadixImpl::RadixNode* node = order[i];
+            RadixFormat::FileNode fileNode{};
+            fileNode.labelOffset = labelBytes;
+            fileNode.labelLength = static_cast<std::uint32_t>(node->word.size());
+            fileNode.firstChild = static_cast<std::uint32_t>(order.size());
+            fileNode.childCount = static_cast<std::uint16_t>(node->children.size());
+            fileNode.isEndOfWord = node->isEndOfWord;
+            fileNodes.push_back(fileNode);
+
+            labelBytes += node->word.size();
+            wordCount += node->isEndOfWord;
+            node->children.forEach([&](unsigned char, const RadixImpl::RadixNode* child) {
+                order.push_back(child);
+            });
+        }
+
+        if (order.size() > UINT32_MAX) {
+            throw MyException("The tree has too many nodes to be saved");
+        }
+
+        RadixFormat::FileHeader header{};
+        std::memcpy(header.magic, RadixFormat::magic, sizeof(header.magic));
+        header.version = RadixFormat::version;
+        header.byteOrderMark = RadixFormat::byteOrderMark;
+        header.nodeCount = order.size();
+        header.wordCount = wordCount;
+        header.nodesOffset = sizeof(header);
+        header.keysOffset = header.nodesOffset + order.size() * sizeof(RadixFormat::FileNode);
+        header.labelsOffset = header.keysOffset + order.size();
+        header.labelBytes = labelBytes;
+
+        // The root has no key, every other node is keyed by the first byte of its label.
+        std::string keys(order.size(), '\0');
+        for (size_t i = 1; i < order.size(); ++i) {
+            keys[i] = order[i]->word[0];
+        }
+
+        bool replaced = RadixFormat::replaceFile(path, [&](std::ofstream& file) {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(fileNodes.data()), fileNodes.size() * sizeof(RadixFormat::FileNode));
+            file.write(keys.data(), keys.size());
+            for (const RadixImpl::RadixNode* node : order) {
+                file.write(node->word.data(), node->word.size());
+            }
+        });
+        if (!replaced) {
+            throw MyException("Couldn't write the tree to " + path);
+        }
+    }
+
+    size_t RadixTree::size() const {
+        return impl().root->wordCount;
+    }
+
+    bool RadixTree::empty() const {
+        return size() == 0;
+    }
+
+    RadixTree::Statistics RadixTree::statistics() const {
+        Statistics statistics;
+        statistics.wordCount = size();
+        RadixImpl::measureShape(impl().root, 0, statistics);
+#ifdef RADIX_TREE_STATS
+        statistics.splits = impl().splits;
+        statistics.merges = impl().merges;
+#endif
+        return statistics;
+    }
+
+    RadixTree::OperationStatistics RadixTree::operationStatistics() {
+        OperationStatistics statistics;
+#ifdef RADIX_TREE_STATS
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        statistics = registry().retired;
+        for (const ThreadCounters* counters : registry().live) {
+            counters->addTo(statistics);
+        }
+#endif
+        return statistics;
+    }
+
+    bool RadixTree::instrumented() {
+#ifdef RADIX_TREE_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
     bool RadixTree::operator==(const RadixTree& other) const{
-        return pImpl->compareTrees(pImpl->root.get(), other.pImpl->root.get());
+        // Trees of different sizes can't be equal, so the structural walk is only needed for equally sized ones.
+        if (size() != other.size()) {
+            return false;
+        }
+        size_t threads = RadixImpl::fanOutThreads(impl().root);
+        if (threads > 1) {
+            return impl().compareRootsParallel(other.impl().root, threads);
+        }
+        return impl().compareTrees(impl().root, other.impl().root);
     }
 
     bool RadixTree::operator!=(const RadixTree& other) const{
@@ -316,56 +2962,121 @@ namespace RadixTreeProject {
     }
 
     bool RadixTree::operator<(const RadixTree& other) const {
-        std::vector<ValueType> wordsInThisTree;
-        std::vector<ValueType> wordsInOtherTree;
-
-        pImpl->collectAllWords(pImpl->root.get(), "", wordsInThisTree);
-        other.pImpl->collectAllWords(other.pImpl->root.get(), "", wordsInOtherTree);
-
-        return wordsInThisTree.size() < wordsInOtherTree.size();
+        return size() < other.size();
     }
 
     bool RadixTree::operator>(const RadixTree& other) const {
-        return !(*this < other);
+        return other < *this;
     }
 
     bool RadixTree::operator<=(const RadixTree& other) const {
-        return ((*this < other) || (*this == other));
+        return !(other < *this);
     }
 
     bool RadixTree::operator>=(const RadixTree& other) const {
-        return ((*this > other) || (*this == other));
+        return !(*this < other);
     }
 
     RadixTree& RadixTree::operator+=(const RadixTree& other) {
-        std::vector<ValueType> wordsInOtherTree;
-        other.pImpl->collectAllWords(other.pImpl->root.get(), "", wordsInOtherTree);
+        if (this != &other) {
+            size_t threads = RadixImpl::fanOutThreads(other.impl().root);
+            if (threads > 1) {
+                impl().mergeRootParallel(other.impl(), threads);
+            }
+            else {
+                impl().mergeNodes<false>(impl().root, other.impl().root, other.impl());
+            }
+            if (impl().reversed) {
+                RadixTree scratch;
+                *impl().reversed += RadixImpl::reversedOf(other.impl(), scratch);
+            }
+        }
+
+        return *this;
+    }
+
+    RadixTree& RadixTree::merge(RadixTree&& other) {
+        if (this == &other) {
+            return *this;
+        }
 
-        for (const auto& word : wordsInOtherTree) {
-            this->insert(word);
+        // The suffix indexes are set aside while the nodes change owners, then merged the same way.
+        std::unique_ptr<RadixTree> reversed = std::move(impl().reversed);
+        std::unique_ptr<RadixTree> otherReversed = std::move(other.impl().reversed);
+        bool otherIndexed = otherReversed != nullptr;
+        if (reversed && !otherReversed) {
+            otherReversed = std::make_unique<RadixTree>(other.impl().buildReversed());
+        }
+
+        // An empty tree of the same kind can simply take over the other tree.
+        if (empty() && impl().pool.isArena() == other.impl().pool.isArena()) {
+            std::swap(pImpl, other.pImpl);
+            !other;
+        }
+        // Nodes change owners between trees of the same kind. Arena nodes stay in their slabs, so the other tree's slabs are kept.
+        else if (impl().pool.isArena() == other.impl().pool.isArena()) {
+            impl().mergeNodes<true>(impl().root, other.impl().root, other.impl());
+            if (impl().pool.isArena()) {
+                impl().donors.push_back(std::move(other.pImpl));
+                other.pImpl = std::make_unique<RadixImpl>(true);
+            }
+            else {
+                !other;
+            }
+        }
+        else {
+            impl().mergeNodes<false>(impl().root, other.impl().root, other.impl());
+            !other;
         }
 
+        if (reversed) {
+            reversed->merge(std::move(*otherReversed));
+            impl().reversed = std::move(reversed);
+        }
+        other.setSuffixIndex(otherIndexed);
         return *this;
     }
 
     RadixTree& RadixTree::operator-=(const RadixTree& other) {
-        std::vector<ValueType> wordsInOtherTree;
-        other.pImpl->collectAllWords(other.pImpl->root.get(), "", wordsInOtherTree);
+        if (this == &other) {
+            return !*this;
+        }
+
+        // Pruning frees labels into the pool that allocated them, so arena trees, whose pool is shared by every label, subtract on one thread.
+        size_t threads = impl().pool.isArena() ? 1 : RadixImpl::fanOutThreads(other.impl().root);
+        if (threads > 1) {
+            impl().subtractRootParallel(other.impl().root, threads);
+        }
+        else {
+            impl().subtractNodes(impl().root, other.impl().root);
+        }
+        if (impl().reversed) {
+            RadixTree scratch;
+            *impl().reversed -= RadixImpl::reversedOf(other.impl(), scratch);
+        }
+
+        return *this;
+    }
 
-        for (const auto& word : wordsInOtherTree) {
-            this->remove(word);
+    RadixTree& RadixTree::operator&=(const RadixTree& other) {
+        if (this != &other) {
+            impl().intersectNodes(impl().root, other.impl().root);
+            if (impl().reversed) {
+                RadixTree scratch;
+                *impl().reversed &= RadixImpl::reversedOf(other.impl(), scratch);
+            }
         }
 
         return *this;
     }
 
     RadixTree& RadixTree::operator!() {
-        pImpl->emptyTree();
+        impl().emptyTree();
         
         return *this;
     }
 
-    bool RadixTree::operator[](const ValueType& word) const {
+    bool RadixTree::operator[](std::string_view word) const {
         return search(word);
     }
 }
\ No newline at end of file
@@ -7,11 +7,22 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <memory>
 #include <exception>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <array>
+#include <optional>
 
 namespace RadixTreeProject {
 
+    class FrozenRadixTree;
+
     /** 
      * @class RadixTree
      * @brief Radix tree data structure for storing words.
@@ -23,15 +34,89 @@ namespace RadixTreeProject {
         private:
             // Declaration of the class implementation, providing a pointer to the tree.
             class RadixImpl;
-            std::unique_ptr<RadixImpl> pImpl;
+            std::unique_ptr<RadixImpl> pImpl; // Null once the tree has been moved from, until it is changed again.
+            bool arenaAfterMove = false; // Allocation mode a moved-from tree creates its implementation in.
+
+            // The implementation, created again when a moved-from tree is changed.
+            RadixImpl& impl();
+            // The implementation, or a shared empty one for a moved-from tree.
+            const RadixImpl& impl() const;
+            bool isArena() const;
 
         public:
             //Creating an alias to be used by the tree's methods.
             using ValueType = std::string;
 
+            /**
+             * @brief Selects where the tree takes the memory for its nodes from.
+             * Heap - every node and label is a separate heap allocation.
+             * Arena - nodes and labels are carved out of slabs owned by the tree,
+             * removed nodes are reused, and clearing or destroying the tree frees whole slabs at once.
+             */
+            enum class AllocationMode { Heap, Arena };
+
+            /**
+             * @brief Shape of a tree, and the structural changes insert and remove made to it.
+             * The shape is measured when statistics() is called. The change counters are only kept
+             * when the library is built with RADIX_TREE_STATS, and stay 0 otherwise.
+             */
+            struct Statistics {
+                size_t nodeCount = 0; // Including the root.
+                size_t wordCount = 0;
+                size_t labelBytes = 0;
+                std::vector<size_t> depthHistogram; // Nodes per depth in edges, the root being at depth 0.
+                std::vector<size_t> fanOutHistogram; // Nodes per number of children.
+                std::vector<size_t> labelLengthHistogram; // Nodes per label length; the root's label is empty.
+                std::array<size_t, 4> nodesByType{}; // Nodes per child table layout, for up to 4, 16, 48 and 256 children.
+                std::array<size_t, 4> bytesByType{}; // Bytes of those nodes and their child tables, labels not included.
+                size_t splits = 0; // Nodes split by insert.
+                size_t merges = 0; // Pass-through nodes joined with their only child by remove and the set operations.
+            };
+
+            /**
+             * @brief Calls and sampled latencies of search, insert and remove, summed over every tree and thread.
+             * Each thread counts into its own slots, which are only added up here. Only kept when the
+             * library is built with RADIX_TREE_STATS; all counts stay 0 otherwise.
+             */
+            struct OperationStatistics {
+                enum Operation { Search, Insert, Remove };
+                static constexpr size_t operationCount = 3;
+                static constexpr size_t bucketCount = 32;
+                static constexpr size_t sampleInterval = 64; // Every thread times one call in this many.
+                std::array<std::uint64_t, operationCount> calls{};
+                std::array<std::array<std::uint64_t, bucketCount>, operationCount> latencyHistogram{}; // Bucket i counts samples of [2^i, 2^(i+1)) ns.
+            };
+
+            /**
+             * @brief How loadFrom splits its input into words and treats words already in the tree.
+             */
+            struct LoadOptions {
+                char delimiter = '\n';
+                bool trimCarriageReturns = true; // Drops a '\r' right before the delimiter, for files with CRLF line ends.
+                bool skipEmpty = true; // Empty words are ignored rather than added.
+                bool skipDuplicates = true; // Duplicates are counted instead of throwing.
+                size_t bufferSize = 1 << 20; // Bytes read at a time from streams; grows for words longer than this.
+            };
+
+            /**
+             * @brief What loadFrom read.
+             */
+            struct LoadStatistics {
+                std::uint64_t bytes = 0;
+                std::uint64_t added = 0;
+                std::uint64_t duplicates = 0;
+                bool sorted = true; // Whether the single-pass builder was used throughout: the tree was empty and the words came in ascending order.
+            };
+
             //Radix tree constructor - creates an empty tree.
             RadixTree();
 
+            /**
+             * @brief Creates an empty tree with the given allocation mode.
+             * @param mode Where the tree's nodes are allocated from.
+             */
+            explicit RadixTree(AllocationMode mode);
+
             //Destructor - deletes the tree and frees the allocated memory.
             ~RadixTree();
 
@@ -48,26 +133,327 @@ namespace RadixTreeProject {
              */
             RadixTree& operator=(const RadixTree& other);
 
+            /**
+             * @brief Move constructor, takes over the other tree's nodes.
+             * @param other The tree to move from. It is left empty, in the same allocation mode, without allocating.
+             */
+            RadixTree(RadixTree&& other) noexcept;
+
+            /**
+             * @brief Move assignment operator, takes over the other tree's nodes.
+             * @param other The tree to move from. It is left empty, in the same allocation mode, without allocating.
+             * @return Reference to the current radix tree.
+             */
+            RadixTree& operator=(RadixTree&& other) noexcept;
+
+            /**
+             * @class Builder
+             * @brief Builds a tree in a single pass from words added in strictly ascending order.
+             *
+             * Each word is attached right after the longest common prefix it shares with the previous word,
+             * so the tree is never walked from the root and no node except the most recent one is revisited.
+             */
+            class Builder {
+                private:
+                    class BuilderImpl;
+                    std::unique_ptr<BuilderImpl> pImpl;
+
+                public:
+                    /**
+                     * @brief Starts building an empty tree.
+                     * @param mode Where the built tree's nodes are allocated from.
+                     */
+                    explicit Builder(AllocationMode mode = AllocationMode::Heap);
+
+                    ~Builder();
+
+                    /**
+                     * @brief Appends a word to the tree being built.
+                     * @param word The word to add, it must be greater than every previously added word.
+                     * @throws an exception if the word is out of order or already added.
+                     */
+                    void add(std::string_view word);
+
+                    /**
+                     * @brief Hands over the built tree. The builder starts over with an empty tree.
+                     * @return The tree containing every added word.
+                     */
+                    RadixTree finish();
+            };
+
+            /**
+             * @brief Builds a tree from a range of words sorted in strictly ascending order.
+             * @param begin Iterator to the first word.
+             * @param end Iterator past the last word.
+             * @param mode Where the tree's nodes are allocated from.
+             * @return The tree containing every word of the range.
+             * @throws an exception if the range isn't sorted or contains duplicates.
+             */
+            template <typename Iterator>
+            static RadixTree fromSorted(Iterator begin, Iterator end, AllocationMode mode = AllocationMode::Heap) {
+                Builder builder(mode);
+                for (; begin != end; ++begin) {
+                    builder.add(*begin);
+                }
+                return builder.finish();
+            }
+
+            /**
+             * @brief Builds a tree from words in any order on several threads.
+             * Words are grouped by their first two bytes. Every thread inserts whole groups into a tree of its own,
+             * taking the largest group left whenever it finishes one. The threads' trees are then joined by
+             * moving their subtrees under one root, without copying or locking.
+             * @param words The words to add.
+             * @param threads Number of threads to use, 0 for threadCount().
+             * @param mode Where the tree's nodes are allocated from.
+             * @return The tree containing every word.
+             * @throws an exception if a word occurs more than once.
+             */
+            static RadixTree buildParallel(const std::vector<ValueType>& words, size_t threads = 0, AllocationMode mode = AllocationMode::Heap);
+            static RadixTree buildParallel(const std::vector<std::string_view>& words, size_t threads = 0, AllocationMode mode = AllocationMode::Heap);
+
+            /**
+             * @brief Sets how many threads copies, +=, -= and == of large trees use, each thread taking whole subtrees of the root.
+             * @param threads Number of threads, 1 to stay on the calling thread, 0 for the number of hardware threads (the default).
+             */
+            static void setThreadCount(size_t threads);
+
+            /**
+             * @brief Returns the number of threads large tree operations and buildParallel use by default.
+             */
+            static size_t threadCount();
+
+            /**
+             * @class ConstIterator
+             * @brief Forward iterator visiting the tree's words in lexicographic order.
+             *
+             * Words are produced lazily into a single buffer reused between steps,
+             * so iterating needs memory proportional to the tree's depth only.
+             * Any modification of the tree invalidates its iterators.
+             */
+            class ConstIterator {
+                private:
+                    class IteratorImpl;
+                    std::unique_ptr<IteratorImpl> pImpl;
+
+                    friend class RadixTree;
+
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = ValueType;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const ValueType*;
+                    using reference = const ValueType&;
+
+                    // Creates an iterator equal to end().
+                    ConstIterator();
+                    ~ConstIterator();
+                    ConstIterator(const ConstIterator& other);
+                    ConstIterator& operator=(const ConstIterator& other);
+                    ConstIterator(ConstIterator&& other) noexcept;
+                    ConstIterator& operator=(ConstIterator&& other) noexcept;
+
+                    /**
+                     * @brief Returns the current word. The reference stays valid until the iterator is advanced.
+                     */
+                    reference operator*() const;
+                    pointer operator->() const;
+
+                    ConstIterator& operator++();
+                    ConstIterator operator++(int);
+
+                    bool operator==(const ConstIterator& other) const;
+                    bool operator!=(const ConstIterator& other) const;
+            };
+
+            using const_iterator = ConstIterator;
+            using iterator = ConstIterator;
+
+            /**
+             * @brief Returns an iterator to the lexicographically smallest word.
+             */
+            ConstIterator begin() const;
+
+            /**
+             * @brief Returns the past-the-end iterator.
+             */
+            ConstIterator end() const;
+
             /**
              * @brief Inserts a new word into the tree.
              * @param word The word to insert into the tree.
-             * @throws an exception if the word already exists.
+             * @throws an exception if the word already exists. Use tryInsert where duplicates are expected.
+             */
+            void insert(std::string_view word);
+
+            /**
+             * @brief Inserts a word unless it is already in the tree, without throwing.
+             * @param word The word to insert into the tree.
+             * @return True if the word was added, false if it already existed.
+             */
+            bool tryInsert(std::string_view word);
+
+            /**
+             * @brief Inserts every word that isn't in the tree yet, skipping the rest.
+             * @param words The words to insert.
+             * @return Number of words added.
+             */
+            size_t insertBatch(const std::vector<ValueType>& words);
+            size_t insertBatch(const std::vector<std::string_view>& words);
+
+            /**
+             * @brief Adds every word of a word list file to the tree.
+             * Regular files are mapped into memory and split in place; other files, like pipes, are read in chunks.
+             * Words are inserted straight from the input without being copied into strings. While the tree is empty
+             * and the words come in ascending order they are appended by the single-pass Builder instead of being inserted.
+             * @param path The file to read.
+             * @param options The delimiter between words and what to do with empty and duplicate words.
+             * @return Number of bytes read, words added and duplicates found.
+             * @throws an exception if the file can't be read, or on a duplicate unless options.skipDuplicates is set.
+             * Words before a duplicate stay in the tree.
+             */
+            LoadStatistics loadFrom(const std::string& path, const LoadOptions& options);
+            LoadStatistics loadFrom(const std::string& path);
+
+            /**
+             * @brief Adds every word read from a stream, like std::cin, to the tree. The stream is read in large chunks.
+             * See loadFrom(path, options) for how the words are split and added.
              */
-            void insert(const ValueType& word);
+            LoadStatistics loadFrom(std::istream& input, const LoadOptions& options);
+            LoadStatistics loadFrom(std::istream& input);
 
             /**
              * @brief Searches for a word in the tree.
              * @param word The word to search in the tree.
              * @return True if the word exists in the tree, false otherwise.
              */
-            bool search(const ValueType& word) const;
+            bool search(std::string_view word) const;
+
+            /**
+             * @brief Searches for many words at once.
+             * The lookups advance in lock-step and prefetch their next node, so their cache misses overlap
+             * instead of being paid one after another as in a loop over search().
+             * @param words The words to search in the tree.
+             * @param found Receives, for every word, whether it exists in the tree.
+             */
+            void searchBatch(const std::vector<ValueType>& words, std::vector<bool>& found) const;
+
+            /**
+             * @brief Searches for many words at once, given as views into the caller's buffers.
+             * @param words The words to search in the tree.
+             * @param found Receives, for every word, whether it exists in the tree.
+             */
+            void searchBatch(const std::vector<std::string_view>& words, std::vector<bool>& found) const;
+
+            /**
+             * @brief Checks whether any word in the tree starts with the given prefix.
+             * @param prefix The prefix to look for.
+             * @return True if at least one word starts with the prefix, false otherwise.
+             */
+            bool hasPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Counts the words starting with the given prefix in O(|prefix|) time.
+             * @param prefix The prefix the words have to start with.
+             * @return Number of words starting with the prefix.
+             */
+            size_t countWithPrefix(std::string_view prefix) const;
+
+            /**
+             * @brief Calls the callback for every word starting with the given prefix, in lexicographic order.
+             * Only the subtree below the prefix is visited, and the walk stops as soon as the limit is reached.
+             * @param prefix The prefix the words have to start with.
+             * @param callback Function called with each matching word.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             */
+            size_t forEachWithPrefix(std::string_view prefix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Finds the longest word in the tree that is a prefix of the given text, walking the tree once.
+             * @param text The text to match, e.g. an address or a path.
+             * @return The part of the text matching the longest such word, or no value if no word is a prefix of the text.
+             */
+            std::optional<std::string_view> longestPrefixOf(std::string_view text) const;
+
+            /**
+             * @brief Turns on or off the suffix index used by endsWith.
+             * The index is a second tree holding every word spelled backwards. While it is on, every change to the tree
+             * is made to the index too, and copies of the tree get an index of their own.
+             * @param enabled True to build the index, false to drop it.
+             */
+            void setSuffixIndex(bool enabled);
+
+            /**
+             * @brief Checks whether the suffix index is on.
+             */
+            bool hasSuffixIndex() const;
+
+            /**
+             * @brief Calls the callback for every word ending with the given suffix.
+             * The suffix index is searched like forEachWithPrefix, so only the matching words are visited.
+             * @param suffix The suffix the words have to end with.
+             * @param callback Function called with each matching word, in lexicographic order of the words spelled backwards.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             * @throws an exception if the suffix index is off.
+             */
+            size_t endsWith(std::string_view suffix, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Finds the words closest to the given one by Levenshtein distance, walking the tree once.
+             * A row of the edit distance table is carried along every edge label, and subtrees whose row
+             * can no longer produce a good enough match are skipped.
+             * @param word The word to match.
+             * @param maxDistance Largest number of single character insertions, deletions and substitutions allowed.
+             * @param limit Maximum number of matches to return; the closest ones are kept.
+             * @return Matching words with their distance, closest first, ties in lexicographic order.
+             */
+            std::vector<std::pair<ValueType, size_t>> searchWithin(std::string_view word, size_t maxDistance, size_t limit = SIZE_MAX) const;
+
+            /**
+             * @brief Calls the callback for every word matching a glob pattern, in lexicographic order.
+             * The pattern is compiled into a small automaton that is stepped along the edge labels,
+             * so subtrees it can't match are skipped as soon as the automaton has no states left.
+             * @param pattern '*' matches any string, '?' any character, [abc], [a-c] and [!a-c] (or [^a-c])
+             * a character class; a backslash makes the next character literal.
+             * @param callback Function called with each matching word.
+             * @param limit Maximum number of words to report.
+             * @return Number of words reported.
+             * @throws an exception if the pattern has an unterminated class or ends with a backslash.
+             */
+            size_t match(std::string_view pattern, const std::function<void(const ValueType&)>& callback, size_t limit = SIZE_MAX) const;
 
             /**
              * @brief Removes a given word from the tree.
+             * Nodes left without words are freed, and a node left with neither a word nor a branch is joined with its only child.
+             * @param word The word to remove from the tree.
+             * @throws an exception if the word doesn't exist in the tree. Use tryRemove where misses are expected.
+             */
+            void remove(std::string_view word);
+
+            /**
+             * @brief Removes a word if it is in the tree, without throwing.
              * @param word The word to remove from the tree.
-             * @throws an exception if the word doesn't exist in the tree.
+             * @return True if the word was removed, false if it wasn't in the tree.
+             */
+            bool tryRemove(std::string_view word);
+
+            /**
+             * @brief Removes every word of the batch that is in the tree, skipping the rest.
+             * @param words The words to remove.
+             * @return Number of words removed.
              */
-            void remove(const ValueType& word);
+            size_t removeBatch(const std::vector<ValueType>& words);
+            size_t removeBatch(const std::vector<std::string_view>& words);
+
+            /**
+             * @brief Rebuilds the tree into fresh memory, allocated in depth-first order with every label trimmed to size.
+             * Meant for long-running processes after heavy churn: free lists and slack capacity are given back.
+             * Only an arena tree ends up in one contiguous run of slabs. In heap mode every node, label and child table
+             * stays a separate allocation, so only the order they are allocated in changes, and where they land is up to the allocator.
+             */
+            void compact();
 
             /**
              * @brief Returns a string representing each word in the tree.
@@ -75,6 +461,19 @@ namespace RadixTreeProject {
              */
             std::string toString() const;
 
+            /**
+             * @brief Writes the tree to a file in a compact, pointer-free format that MappedRadixTree can map directly.
+             * @param path Path of the file to write, an existing file is overwritten.
+             * @throws an exception if the file can't be written.
+             */
+            void save(const std::string& path) const;
+
+            /**
+             * @brief Makes an immutable, succinct copy of the tree for dictionaries that are no longer modified.
+             * @return The frozen copy; include FrozenRadixTree.h to use it.
+             */
+            FrozenRadixTree freeze() const;
+
             /**
              * @brief Compares two radix trees for equality.
              * @param other The radix tree to compare with.
@@ -89,6 +488,32 @@ namespace RadixTreeProject {
              */
             bool operator!=(const RadixTree& other) const;
 
+            /**
+             * @brief Returns the number of words stored in the tree in O(1) time.
+             */
+            size_t size() const;
+
+            /**
+             * @brief Checks whether the tree stores no words.
+             */
+            bool empty() const;
+
+            /**
+             * @brief Walks the tree and measures its shape, along with the split and merge counts.
+             * @return Histograms of node depth, fan-out and label length, and node counts and bytes per layout.
+             */
+            Statistics statistics() const;
+
+            /**
+             * @brief Adds up the per-thread operation counters of the whole process.
+             */
+            static OperationStatistics operationStatistics();
+
+            /**
+             * @brief Checks whether the library was built with RADIX_TREE_STATS, so the counters are kept.
+             */
+            static bool instrumented();
+
             /**
              * @brief Checks if current tree has less words saved than another tree.
              * @param other The radix tree to compare with.
@@ -104,33 +529,52 @@ namespace RadixTreeProject {
             bool operator>(const RadixTree& other) const;
 
             /**
-             * @brief Checks if the current radix tree is equal to the other or has less words.
+             * @brief Checks if the current radix tree has no more words than the other.
              * @param other The radix tree to compare with.
-             * @return True if either condition if met, false otherwise.
+             * @return True if the current tree has less or as many words as the other tree, false otherwise.
              */
             bool operator<=(const RadixTree& other) const;
 
             /**
-             * @brief Checks if the current radix tree is equal to the other or has more words.
+             * @brief Checks if the current radix tree has no less words than the other.
              * @param other The radix tree to compare with.
-             * @return True if either condition if met, false otherwise.
+             * @return True if the current tree has more or as many words as the other tree, false otherwise.
              */
             bool operator>=(const RadixTree& other) const;
 
             /**
              * @brief Merges the current tree with another.
+             * Both trees are walked together, subtrees missing from the current tree are copied over whole,
+             * and nodes are only split where the labels diverge. Words already in the current tree are skipped.
              * @param other The tree to merge into the current one.
              * @return Reference to the current radix tree.
              */
             RadixTree& operator+=(const RadixTree& other);
 
+            /**
+             * @brief Merges another tree into the current one, moving its subtrees instead of copying them.
+             * Subtrees are moved between trees of the same allocation mode, otherwise they are copied.
+             * An arena tree keeps the other tree's slabs, which its moved nodes live in.
+             * @param other The tree to merge into the current one. It is left empty.
+             * @return Reference to the current radix tree.
+             */
+            RadixTree& merge(RadixTree&& other);
+
             /**
              * @brief Removes another tree's words from the current one.
+             * Both trees are walked together, words missing from the current tree are ignored.
              * @param other The tree words of which will be removed from the current one.
              * @return Reference to the current radix tree.
              */
             RadixTree& operator-=(const RadixTree& other);
 
+            /**
+             * @brief Keeps only the words that are also stored in another tree.
+             * @param other The tree to intersect with.
+             * @return Reference to the current radix tree.
+             */
+            RadixTree& operator&=(const RadixTree& other);
+
             /**
              * @brief Clears the current radix tree but doesn't delete it.
              * @return Reference to the current radix tree.
@@ -142,7 +586,7 @@ namespace RadixTreeProject {
              * @param word The word to be searched.
              * @return True if the word exists in the tree, false otherwise.
              */
-            bool operator[](const ValueType& word) const;
+            bool operator[](std::string_view word) const;
 
     };
 
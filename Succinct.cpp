@@ -0,0 +1,62 @@
+#include "Succinct.h"
+#include <algorithm>
+
+namespace RadixTreeProject {
+    namespace Succinct {
+        void BitVector::finish() {
+            words.shrink_to_fit();
+            blockRanks.assign(words.size() / 8 + 2, 0);
+            selectSamples.clear();
+            size_t ones = 0;
+            for (size_t i = 0; i < words.size(); ++i) {
+                if (i % 8 == 0) {
+                    blockRanks[i / 8] = ones;
+                }
+                size_t count = __builtin_popcountll(words[i]);
+                // Sample the block in which the next multiple of 512 ones falls.
+                while (selectSamples.size() * 512 < ones + count) {
+                    selectSamples.push_back(static_cast<std::uint32_t>(i / 8));
+                }
+                ones += count;
+            }
+            for (size_t block = (words.size() + 7) / 8; block < blockRanks.size(); ++block) {
+                blockRanks[block] = ones;
+            }
+            selectSamples.push_back(static_cast<std::uint32_t>(blockRanks.size() - 1));
+        }
+
+        size_t BitVector::select1(size_t index) const {
+            // The one lies in the last block that starts with at most index ones before it.
+            size_t sample = index / 512;
+            auto first = blockRanks.begin() + selectSamples[sample];
+            auto last = blockRanks.begin() + std::min<size_t>(selectSamples[sample + 1] + 1, blockRanks.size());
+            size_t block = static_cast<size_t>(std::upper_bound(first, last, index) - blockRanks.begin()) - 1;
+
+            size_t remaining = index - blockRanks[block];
+            size_t word = block * 8;
+            size_t count = __builtin_popcountll(words[word]);
+            while (remaining >= count) {
+                remaining -= count;
+                count = __builtin_popcountll(words[++word]);
+            }
+            std::uint64_t bits = words[word];
+            for (; remaining > 0; --remaining) {
+                bits &= bits - 1;
+            }
+            return word * 64 + __builtin_ctzll(bits);
+        }
+
+        void LoudsTree::finish() {
+            louds.push_back(true);
+            tailStarts.push_back(true);
+            // findKey16 reads 16 keys at a time, even at the end of the array.
+            keys.insert(keys.end(), 16, 0);
+            keys.shrink_to_fit();
+            tails.shrink_to_fit();
+            louds.finish();
+            hasChild.finish();
+            isEndOfWord.finish();
+            tailStarts.finish();
+        }
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @author: Arturas Timofejevas (@Rave1s), VU SE 2 course 2 group
+*/
+
+#ifndef SUCCINCT_H
+#define SUCCINCT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RadixTreeProject {
+
+    /**
+     * @brief Bit vectors with rank and select, and the LOUDS layout RadixTree::freeze fills for FrozenRadixTree.
+     */
+    namespace Succinct {
+        /**
+         * @class BitVector
+         * @brief Append-only bit vector answering rank and select queries once it is finished.
+         *
+         * Ones are counted per block of 512 bits, and the block of every 512th one is sampled,
+         * so rank is a lookup plus at most eight popcounts and select a short binary search.
+         */
+        class BitVector {
+            private:
+                std::vector<std::uint64_t> words;
+                size_t bitCount = 0;
+                std::vector<std::uint64_t> blockRanks; // Ones before each 512 bit block, plus the total at the end.
+                std::vector<std::uint32_t> selectSamples; // Block holding every 512th one.
+
+            public:
+                void push_back(bool bit) {
+                    if (bitCount % 64 == 0) {
+                        words.push_back(0);
+                    }
+                    if (bit) {
+                        words.back() |= std::uint64_t(1) << (bitCount % 64);
+                    }
+                    ++bitCount;
+                }
+
+                /**
+                 * @brief Builds the rank and select directories. Has to be called after the last push_back.
+                 */
+                void finish();
+
+                bool operator[](size_t position) const {
+                    return (words[position / 64] >> (position % 64)) & 1;
+                }
+
+                size_t size() const {
+                    return bitCount;
+                }
+
+                /**
+                 * @brief Counts the ones before the given position.
+                 */
+                size_t rank1(size_t position) const {
+                    size_t word = position / 64;
+                    size_t count = blockRanks[word / 8];
+                    for (size_t i = word / 8 * 8; i < word; ++i) {
+                        count += __builtin_popcountll(words[i]);
+                    }
+                    if (position % 64) {
+                        count += __builtin_popcountll(words[word] << (64 - position % 64));
+                    }
+                    return count;
+                }
+
+                /**
+                 * @brief Finds the position of the one with the given index, counting from 0.
+                 * The index has to be smaller than the number of ones.
+                 */
+                size_t select1(size_t index) const;
+
+                /**
+                 * @brief Finds the first one at or after the given position; size() if there is none.
+                 */
+                size_t nextOne(size_t position) const {
+                    size_t word = position / 64;
+                    if (word >= words.size()) {
+                        return bitCount;
+                    }
+                    std::uint64_t bits = words[word] & (~std::uint64_t(0) << (position % 64));
+                    while (!bits) {
+                        if (++word == words.size()) {
+                            return bitCount;
+                        }
+                        bits = words[word];
+                    }
+                    return word * 64 + __builtin_ctzll(bits);
+                }
+
+                /**
+                 * @brief Returns the number of heap bytes used by the bits and the directories.
+                 */
+                size_t memoryUsage() const {
+                    return words.capacity() * sizeof(std::uint64_t) + blockRanks.capacity() * sizeof(std::uint64_t) + selectSamples.capacity() * sizeof(std::uint32_t);
+                }
+        };
+
+        /**
+         * @brief A path-compressed trie in LOUDS-Sparse form: every array is indexed by edge, in breadth-first order.
+         *
+         * Each non-root node is the edge leading to it. The children of a node are consecutive edges,
+         * sorted by key; louds marks the first of them. Nodes that have children are numbered in
+         * breadth-first order with the root as 0, so the node an edge leads to is numbered by the
+         * ones in hasChild up to and including that edge, and its children start at that one in louds.
+         * The label of an edge is its key followed by its tail. tailStarts holds a one for every
+         * edge followed by a zero per tail byte, which places each tail in the packed tails string.
+         */
+        struct LoudsTree {
+            std::vector<unsigned char> keys; // First label byte of every edge, followed by 16 bytes of padding.
+            BitVector louds; // One extra one at the end closes the last child list.
+            BitVector hasChild;
+            BitVector isEndOfWord;
+            BitVector tailStarts; // One extra one at the end closes the last tail.
+            std::string tails;
+            bool rootIsEndOfWord = false;
+            std::uint64_t wordCount = 0;
+
+            /**
+             * @brief Appends the edge leading to a node, after the edges of every node before it in breadth-first order.
+             * @param label The node's whole label.
+             * @param firstChild Whether this is the first child of its parent.
+             */
+            void addEdge(const char* label, size_t length, bool firstChild, bool hasChildren, bool endOfWord) {
+                keys.push_back(static_cast<unsigned char>(label[0]));
+                louds.push_back(firstChild);
+                hasChild.push_back(hasChildren);
+                isEndOfWord.push_back(endOfWord);
+                tailStarts.push_back(true);
+                for (size_t i = 1; i < length; ++i) {
+                    tailStarts.push_back(false);
+                }
+                tails.append(label + 1, length - 1);
+            }
+
+            /**
+             * @brief Closes the last child list and tail, and builds the rank and select directories.
+             */
+            void finish();
+
+            size_t edgeCount() const {
+                return hasChild.size();
+            }
+
+            size_t memoryUsage() const {
+                return keys.capacity() + tails.capacity() + louds.memoryUsage() + hasChild.memoryUsage() + isEndOfWord.memoryUsage() + tailStarts.memoryUsage();
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,1073 @@
+#include "RadixTree.h"
+#include "MappedRadixTree.h"
+#include "FrozenRadixTree.h"
+#include "ConcurrentRadixTree.h"
+#include "DurableRadixTree.h"
+#include "PrefixMatch.h"
+#include "RadixMap.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <filesystem>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace RadixTreeProject;
+
+// Global allocation counters, used to report how much memory the tree owns per key.
+// Every block carries a small header with its size so that live bytes can be tracked on delete.
+// The counters are atomic because the concurrent section allocates from several threads.
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> liveBytes(0);
+static constexpr size_t headerSize = alignof(std::max_align_t);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size + headerSize)) {
+        *static_cast<size_t*>(ptr) = size;
+        return static_cast<char*>(ptr) + headerSize;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    void* block = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(ptr) - headerSize);
+    liveBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+/**
+ * @brief Generates a dictionary-like corpus of unique words.
+ * Words share prefixes the way natural language words do, so the tree gets both long edges and wide nodes.
+ */
+std::vector<std::string> makeCorpus(size_t count, unsigned seed) {
+    static const char* stems[] = {"toast", "car", "bar", "bank", "inter", "pre", "trans", "con", "de", "re", "un", "over"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> length(3, 12);
+    std::uniform_int_distribution<int> stem(0, sizeof(stems) / sizeof(stems[0]) - 1);
+
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string word = stems[stem(rng)];
+        int extra = length(rng);
+        for (int j = 0; j < extra; ++j) {
+            word += static_cast<char>(letter(rng));
+        }
+        // Suffixing the index keeps every word unique.
+        word += std::to_string(i);
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+/**
+ * @brief Generates unique keys of random lowercase letters and digits, 8 to 24 long, which share little beyond the first few bytes.
+ */
+std::vector<std::string> makeRandomCorpus(size_t count, unsigned seed) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> letter(0, sizeof(alphabet) - 2);
+    std::uniform_int_distribution<int> length(8, 24);
+
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string word;
+        int size = length(rng);
+        for (int j = 0; j < size; ++j) {
+            word += alphabet[letter(rng)];
+        }
+        word += std::to_string(i);
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+/**
+ * @brief Generates unique URL-like keys: a scheme, one of a limited number of hosts and a path from a small vocabulary.
+ * Long shared prefixes end in wide nodes, as in a crawler's URL set.
+ */
+std::vector<std::string> makeUrlCorpus(size_t count, unsigned seed) {
+    static const char* segments[] = {"api", "v1", "v2", "users", "items", "search", "static", "img", "docs", "blog", "cart", "account"};
+    static const char* domains[] = {".com", ".org", ".net", ".io"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> host(0, count / 100 + 1);
+    std::uniform_int_distribution<int> segment(0, sizeof(segments) / sizeof(segments[0]) - 1);
+    std::uniform_int_distribution<int> depth(1, 4);
+
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t hostIndex = host(rng);
+        std::string word = (hostIndex % 3 ? "https://www.site" : "http://site") + std::to_string(hostIndex) + domains[hostIndex % 4];
+        int segmentCount = depth(rng);
+        for (int j = 0; j < segmentCount; ++j) {
+            word += '/';
+            word += segments[segment(rng)];
+        }
+        word += "?id=" + std::to_string(i);
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+template <typename Func>
+double nanosecondsPerOp(size_t operations, Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / operations;
+}
+
+/**
+ * @class HardwareCounters
+ * @brief Counts the calling thread's cache misses and branch misses with perf_event_open.
+ * Where the kernel doesn't allow it, or on other systems, available() is false and the counts stay 0.
+ */
+class HardwareCounters {
+    private:
+        int cacheMissesFd = -1;
+        int branchMissesFd = -1;
+
+#ifdef __linux__
+        static int open(std::uint64_t config, int groupFd) {
+            perf_event_attr attributes{};
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.size = sizeof(attributes);
+            attributes.config = config;
+            attributes.disabled = groupFd < 0;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+        }
+
+        static std::uint64_t read(int fd) {
+            std::uint64_t value = 0;
+            return ::read(fd, &value, sizeof(value)) == sizeof(value) ? value : 0;
+        }
+#endif
+
+    public:
+        HardwareCounters() {
+#ifdef __linux__
+            cacheMissesFd = open(PERF_COUNT_HW_CACHE_MISSES, -1);
+            if (cacheMissesFd >= 0) {
+                branchMissesFd = open(PERF_COUNT_HW_BRANCH_MISSES, cacheMissesFd);
+            }
+#endif
+        }
+
+        ~HardwareCounters() {
+#ifdef __linux__
+            if (branchMissesFd >= 0) {
+                close(branchMissesFd);
+            }
+            if (cacheMissesFd >= 0) {
+                close(cacheMissesFd);
+            }
+#endif
+        }
+
+        HardwareCounters(const HardwareCounters&) = delete;
+        HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+        bool available() const {
+            return branchMissesFd >= 0;
+        }
+
+        void start() {
+#ifdef __linux__
+            if (available()) {
+                ioctl(cacheMissesFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(cacheMissesFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+
+        void stop(std::uint64_t& cacheMisses, std::uint64_t& branchMisses) {
+            cacheMisses = 0;
+            branchMisses = 0;
+#ifdef __linux__
+            if (available()) {
+                ioctl(cacheMissesFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                cacheMisses = read(cacheMissesFd);
+                branchMisses = read(branchMissesFd);
+            }
+#endif
+        }
+};
+
+struct Measurement {
+    double nanoseconds;
+    double allocations;
+    double cacheMisses;
+    double branchMisses;
+};
+
+/**
+ * @brief Runs the function once and divides its time, allocations and hardware counts by the number of operations.
+ */
+template <typename Func>
+Measurement measure(HardwareCounters& counters, size_t operations, Func&& func) {
+    size_t allocationsBefore = allocationCount;
+    std::uint64_t cacheMisses;
+    std::uint64_t branchMisses;
+    counters.start();
+    double nanoseconds = nanosecondsPerOp(operations, func);
+    counters.stop(cacheMisses, branchMisses);
+    double count = static_cast<double>(operations);
+    return {nanoseconds, (allocationCount - allocationsBefore) / count, cacheMisses / count, branchMisses / count};
+}
+
+void printMeasurement(const char* operation, const Measurement& measurement, bool withCounters) {
+    std::cout << std::left << std::setw(16) << operation << std::right
+              << std::setw(10) << measurement.nanoseconds << std::setw(11) << measurement.allocations;
+    if (withCounters) {
+        std::cout << std::setw(14) << measurement.cacheMisses << std::setw(15) << measurement.branchMisses;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * @brief Runs every tree operation on one corpus, inserted either in sorted or shuffled order.
+ * Copying, merging, subtracting, toString and iteration are reported per key; the rest per call.
+ * @return False if the lookups didn't find exactly the inserted words.
+ */
+bool benchmarkCorpus(const char* corpus, std::vector<std::string> words, const std::vector<std::string>& misses, bool sorted, HardwareCounters& counters) {
+    std::vector<std::string> lookups = words;
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(3));
+    if (sorted) {
+        std::sort(words.begin(), words.end());
+    }
+    std::cout << "[suite " << corpus << " " << words.size() << " " << (sorted ? "sorted" : "shuffled") << "]\n";
+
+    RadixTree tree;
+    size_t bytesBefore = liveBytes;
+    Measurement insert = measure(counters, words.size(), [&] {
+        for (const auto& word : words) {
+            tree.insert(word);
+        }
+    });
+    size_t treeBytes = liveBytes - bytesBefore;
+
+    size_t found = 0;
+    Measurement hit = measure(counters, lookups.size(), [&] {
+        for (const auto& word : lookups) {
+            found += tree.search(word);
+        }
+    });
+    Measurement miss = measure(counters, misses.size(), [&] {
+        for (const auto& word : misses) {
+            found += tree.search(word);
+        }
+    });
+
+    std::unique_ptr<RadixTree> copy;
+    Measurement copying = measure(counters, words.size(), [&] {
+        copy = std::make_unique<RadixTree>(tree);
+    });
+
+    // The odd half of the lookups is taken out and merged back in.
+    RadixTree half;
+    for (size_t i = 1; i < lookups.size(); i += 2) {
+        half.insert(lookups[i]);
+    }
+    Measurement subtract = measure(counters, words.size(), [&] {
+        *copy -= half;
+    });
+    Measurement merge = measure(counters, words.size(), [&] {
+        *copy += half;
+    });
+    bool merged = *copy == tree;
+    copy.reset();
+    half = RadixTree();
+
+    size_t textBytes = 0;
+    Measurement text = measure(counters, words.size(), [&] {
+        textBytes += tree.toString().size();
+    });
+    size_t iteratedBytes = 0;
+    Measurement iterate = measure(counters, words.size(), [&] {
+        for (const auto& word : tree) {
+            iteratedBytes += word.size();
+        }
+    });
+    Measurement remove = measure(counters, lookups.size(), [&] {
+        for (const auto& word : lookups) {
+            tree.remove(word);
+        }
+    });
+
+    if (found != words.size() || !merged || !tree.empty() || textBytes < iteratedBytes) {
+        std::cerr << "Suite mismatch on the " << corpus << " corpus" << std::endl;
+        return false;
+    }
+
+    bool withCounters = counters.available();
+    std::cout << "bytes/key:      " << static_cast<double>(treeBytes) / words.size() << "\n";
+    std::cout << std::left << std::setw(16) << "op" << std::right << std::setw(10) << "ns/op" << std::setw(11) << "allocs/op";
+    if (withCounters) {
+        std::cout << std::setw(14) << "cache-miss/op" << std::setw(15) << "branch-miss/op";
+    }
+    std::cout << "\n";
+    printMeasurement("insert", insert, withCounters);
+    printMeasurement("search hit", hit, withCounters);
+    printMeasurement("search miss", miss, withCounters);
+    printMeasurement("remove", remove, withCounters);
+    printMeasurement("copy", copying, withCounters);
+    printMeasurement("-= half", subtract, withCounters);
+    printMeasurement("+= half", merge, withCounters);
+    printMeasurement("toString", text, withCounters);
+    printMeasurement("iterate", iterate, withCounters);
+    std::cout << std::flush;
+    return true;
+}
+
+/**
+ * @brief Runs benchmarkCorpus on the random, URL-like and dictionary corpora, from 1K keys up to maxKeys by factors of ten.
+ * Corpora come from fixed seeds, so runs on the same machine are comparable.
+ */
+int runSuite(size_t maxKeys) {
+    using Generator = std::vector<std::string> (*)(size_t, unsigned);
+    static const std::pair<const char*, Generator> corpora[] = {{"random", makeRandomCorpus}, {"url", makeUrlCorpus}, {"dictionary", makeCorpus}};
+    HardwareCounters counters;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "hardware counters:  " << (counters.available() ? "on" : "unavailable") << "\n";
+    for (size_t keys = 1000; keys <= maxKeys; keys *= 10) {
+        for (const auto& [name, generate] : corpora) {
+            std::vector<std::string> words = generate(keys, 42);
+            std::vector<std::string> misses = generate(keys, 7);
+            for (auto& word : misses) {
+                word += '#';
+            }
+            if (!benchmarkCorpus(name, words, misses, false, counters) || !benchmarkCorpus(name, words, misses, true, counters)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds a tree with the given allocation mode and reports its memory use and latencies.
+ * @return False if the lookups didn't find exactly the inserted words.
+ */
+bool benchmarkTree(const char* name, RadixTree::AllocationMode mode, const std::vector<std::string>& words,
+                   const std::vector<std::string>& lookups, const std::vector<std::string>& misses) {
+    RadixTree tree(mode);
+    size_t countBefore = allocationCount;
+    size_t bytesBefore = liveBytes;
+    double insertNs = nanosecondsPerOp(words.size(), [&] {
+        for (const auto& word : words) {
+            tree.insert(word);
+        }
+    });
+    size_t treeAllocations = allocationCount - countBefore;
+    size_t treeBytes = liveBytes - bytesBefore;
+
+    size_t found = 0;
+    double hitNs = nanosecondsPerOp(lookups.size(), [&] {
+        for (const auto& word : lookups) {
+            found += tree.search(word);
+        }
+    });
+    double missNs = nanosecondsPerOp(misses.size(), [&] {
+        for (const auto& word : misses) {
+            found += tree.search(word);
+        }
+    });
+
+    // Request handlers look up a few hundred tokens at once.
+    static constexpr size_t batchSize = 256;
+    std::vector<std::string> batch;
+    std::vector<bool> batchFound;
+    size_t batchHits = 0;
+    double batchNs = nanosecondsPerOp(lookups.size(), [&] {
+        for (size_t first = 0; first < lookups.size(); first += batchSize) {
+            batch.assign(lookups.begin() + first, lookups.begin() + std::min(first + batchSize, lookups.size()));
+            tree.searchBatch(batch, batchFound);
+            batchHits += std::count(batchFound.begin(), batchFound.end(), true);
+        }
+    });
+
+    // Autocomplete: counting and listing the first ten completions of short prefixes.
+    size_t prefixCount = std::min<size_t>(lookups.size(), 100000);
+    size_t completions = 0;
+    double countNs = nanosecondsPerOp(prefixCount, [&] {
+        for (size_t i = 0; i < prefixCount; ++i) {
+            completions += tree.countWithPrefix(lookups[i].substr(0, 4));
+        }
+    });
+    double completeNs = nanosecondsPerOp(prefixCount, [&] {
+        for (size_t i = 0; i < prefixCount; ++i) {
+            completions += tree.forEachWithPrefix(lookups[i].substr(0, 4), [](const std::string&) {}, 10);
+        }
+    });
+
+    size_t iteratedBytes = 0;
+    double iterateNs = nanosecondsPerOp(words.size(), [&] {
+        for (const auto& word : tree) {
+            iteratedBytes += word.size();
+        }
+    });
+
+    // Remove and re-insert a tenth of the words to exercise node reuse.
+    size_t churn = words.size() / 10;
+    double churnNs = nanosecondsPerOp(2 * churn, [&] {
+        for (size_t i = 0; i < churn; ++i) {
+            tree.remove(lookups[i]);
+        }
+        for (size_t i = 0; i < churn; ++i) {
+            tree.insert(lookups[i]);
+        }
+    });
+
+    // A daemon compacting after the churn: rebuilding, then looking the words up again in the fresh layout.
+    double compactNs = nanosecondsPerOp(words.size(), [&] {
+        tree.compact();
+    });
+    double compactedHitNs = nanosecondsPerOp(lookups.size(), [&] {
+        for (const auto& word : lookups) {
+            found -= !tree.search(word);
+        }
+    });
+
+    double clearNs = nanosecondsPerOp(words.size(), [&] {
+        !tree;
+    });
+
+    if (found != words.size() || batchHits != words.size()) {
+        std::cerr << "Lookup mismatch: found " << found << " and " << batchHits << " of " << words.size() << std::endl;
+        return false;
+    }
+
+    size_t keyCount = words.size();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "[" << name << "]\n";
+    std::cout << "allocations/key:    " << static_cast<double>(treeAllocations) / keyCount << "\n";
+    std::cout << "bytes/key:          " << static_cast<double>(treeBytes) / keyCount << "\n";
+    std::cout << "insert ns/op:       " << insertNs << "\n";
+    std::cout << "search hit ns/op:   " << hitNs << "\n";
+    std::cout << "search miss ns/op:  " << missNs << "\n";
+    std::cout << "searchBatch ns/op:  " << batchNs << "\n";
+    std::cout << "countWithPrefix ns: " << countNs << "\n";
+    std::cout << "top-10 prefix ns:   " << completeNs << "\n";
+    std::cout << "iterate ns/key:     " << iterateNs << " (" << iteratedBytes << " bytes)\n";
+    std::cout << "remove+insert ns/op:" << churnNs << "\n";
+    std::cout << "compact ns/key:     " << compactNs << "\n";
+    std::cout << "compacted hit ns/op:" << compactedHitNs << "\n";
+    std::cout << "clear ns/key:       " << clearNs << std::endl;
+    return true;
+}
+
+/**
+ * @brief Times the label comparison kernels on label pairs whose common prefix length follows a distribution.
+ * Each pair matches for the drawn length and differs right after it, like an edge being split.
+ */
+void benchmarkPrefixKernel(const char* name, size_t minLength, size_t maxLength) {
+    static constexpr size_t pairCount = 4096;
+    static constexpr size_t rounds = 200;
+    std::mt19937 random(5);
+    std::uniform_int_distribution<size_t> lengths(minLength, maxLength);
+    std::vector<std::string> labels(pairCount);
+    std::vector<std::string> others(pairCount);
+    for (size_t i = 0; i < pairCount; ++i) {
+        size_t length = lengths(random);
+        labels[i].assign(length + 1, '/');
+        others[i] = labels[i];
+        others[i][length] = '#';
+    }
+
+    size_t checksum = 0;
+    double scalarNs = nanosecondsPerOp(pairCount * rounds, [&] {
+        for (size_t round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < pairCount; ++i) {
+                checksum += PrefixMatch::commonPrefixLengthScalar(labels[i].data(), others[i].data(), labels[i].size());
+            }
+        }
+    });
+    double kernelNs = nanosecondsPerOp(pairCount * rounds, [&] {
+        for (size_t round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < pairCount; ++i) {
+                checksum -= PrefixMatch::commonPrefixLength(labels[i].data(), others[i].data(), labels[i].size());
+            }
+        }
+    });
+    std::cout << name << " scalar/" << PrefixMatch::kernelName() << " ns: " << scalarNs << " / " << kernelNs
+              << (checksum ? " (mismatch)" : "") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    // "bench suite [maxKeys]" runs the corpus suite instead of the default sections.
+    if (argc > 1 && std::string(argv[1]) == "suite") {
+        return runSuite(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000);
+    }
+    size_t keyCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::vector<std::string> words = makeCorpus(keyCount, 42);
+    std::vector<std::string> misses = makeCorpus(keyCount, 7);
+    for (auto& word : misses) {
+        word += '#';
+    }
+
+    std::vector<std::string> lookups = words;
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(1));
+
+    std::cout << "keys:               " << keyCount << "\n";
+    if (!benchmarkTree("heap", RadixTree::AllocationMode::Heap, words, lookups, misses) ||
+        !benchmarkTree("arena", RadixTree::AllocationMode::Arena, words, lookups, misses)) {
+        return 1;
+    }
+
+    // Startup path: loading pre-sorted words one insert at a time versus the single-pass builder.
+    // Each tree is freed before the next one is built, so both get recycled rather than fresh memory.
+    std::vector<std::string> sortedWords = words;
+    std::sort(sortedWords.begin(), sortedWords.end());
+    double sortedInsertNs = 0;
+    double bulkLoadNs = 0;
+    for (int round = 0; round < 2; ++round) {
+        {
+            RadixTree insertedTree;
+            sortedInsertNs = nanosecondsPerOp(sortedWords.size(), [&] {
+                for (const auto& word : sortedWords) {
+                    insertedTree.insert(word);
+                }
+            });
+        }
+        {
+            RadixTree bulkTree;
+            bulkLoadNs = nanosecondsPerOp(sortedWords.size(), [&] {
+                bulkTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+            });
+        }
+    }
+    std::cout << "[sorted load]\n";
+    std::cout << "insert ns/key:      " << sortedInsertNs << "\n";
+    std::cout << "fromSorted ns/key:  " << bulkLoadNs << std::endl;
+
+    // Word list ingestion: a getline loop of inserts versus loadFrom, for the shuffled and the sorted list.
+    {
+        const char* listPath = "bench_words.txt";
+        std::cout << "[loading]\n";
+        for (const auto* list : {&lookups, &sortedWords}) {
+            size_t fileBytes = 0;
+            {
+                std::ofstream listFile(listPath, std::ios::binary);
+                for (const auto& word : *list) {
+                    listFile << word << '\n';
+                    fileBytes += word.size() + 1;
+                }
+            }
+            double getlineNs = 0;
+            double loadNs = 0;
+            for (int round = 0; round < 2; ++round) {
+                {
+                    RadixTree getlineTree;
+                    getlineNs = nanosecondsPerOp(list->size(), [&] {
+                        std::ifstream listFile(listPath);
+                        std::string line;
+                        while (std::getline(listFile, line)) {
+                            getlineTree.insert(line);
+                        }
+                    });
+                }
+                {
+                    RadixTree loadedTree;
+                    loadNs = nanosecondsPerOp(list->size(), [&] {
+                        loadedTree.loadFrom(listPath);
+                    });
+                    if (loadedTree.size() != list->size()) {
+                        std::cerr << "loading: wrong size\n";
+                        return 1;
+                    }
+                }
+            }
+            const char* order = list == &sortedWords ? "sorted" : "shuffled";
+            std::cout << order << " getline ns/key: " << getlineNs << "\n";
+            std::cout << order << " loadFrom ns/key: " << loadNs << " (" << fileBytes / (loadNs * list->size()) * 1000 << " MB/s)\n";
+        }
+        std::cout << std::flush;
+        std::remove(listPath);
+    }
+
+    // Tree shape, for reading the latencies above against depth and node layouts.
+    {
+        RadixTree shapeTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        RadixTree::Statistics shape = shapeTree.statistics();
+        double depthSum = 0;
+        for (size_t depth = 0; depth < shape.depthHistogram.size(); ++depth) {
+            depthSum += static_cast<double>(depth) * shape.depthHistogram[depth];
+        }
+        std::cout << "[shape]\n";
+        std::cout << "nodes/key:          " << static_cast<double>(shape.nodeCount) / shape.wordCount << "\n";
+        std::cout << "mean/max depth:     " << depthSum / shape.nodeCount << " / " << shape.depthHistogram.size() - 1 << "\n";
+        std::cout << "nodes 4/16/48/256:  " << shape.nodesByType[0] << " / " << shape.nodesByType[1] << " / "
+                  << shape.nodesByType[2] << " / " << shape.nodesByType[3] << std::endl;
+    }
+
+    // Spell correction: each query is a dictionary word with one character replaced.
+    {
+        RadixTree dictionary = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        size_t queryCount = std::min<size_t>(lookups.size(), 2000);
+        std::vector<std::string> typos(lookups.begin(), lookups.begin() + queryCount);
+        for (size_t i = 0; i < queryCount; ++i) {
+            typos[i][i % typos[i].size()] = 'q';
+        }
+        size_t suggestions = 0;
+        std::cout << "[fuzzy]\n";
+        for (size_t distance = 1; distance <= 2; ++distance) {
+            double fuzzyNs = nanosecondsPerOp(queryCount, [&] {
+                for (const auto& typo : typos) {
+                    suggestions += dictionary.searchWithin(typo, distance, 10).size();
+                }
+            });
+            std::cout << "distance " << distance << " us/query:" << fuzzyNs / 1000 << "\n";
+        }
+        std::cout << "suggestions/query:  " << static_cast<double>(suggestions) / (2 * queryCount) << std::endl;
+    }
+
+    // Glob queries: a word with one character wildcarded, and a word's first three characters followed by a star.
+    {
+        RadixTree dictionary = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        size_t queryCount = std::min<size_t>(lookups.size(), 2000);
+        std::vector<std::string> wildcarded(lookups.begin(), lookups.begin() + queryCount);
+        std::vector<std::string> stems;
+        for (size_t i = 0; i < queryCount; ++i) {
+            wildcarded[i][i % wildcarded[i].size()] = '?';
+            stems.push_back(lookups[i].substr(0, 3) + "*");
+        }
+        size_t matched = 0;
+        auto count = [&](const std::string&) { ++matched; };
+        double wildcardNs = nanosecondsPerOp(queryCount, [&] {
+            for (const auto& pattern : wildcarded) {
+                dictionary.match(pattern, count);
+            }
+        });
+        double stemNs = nanosecondsPerOp(queryCount, [&] {
+            for (const auto& pattern : stems) {
+                dictionary.match(pattern, count, 100);
+            }
+        });
+        std::cout << "[glob]\n";
+        std::cout << "one ? us/pattern:   " << wildcardNs / 1000 << "\n";
+        std::cout << "stem* us/pattern:   " << stemNs / 1000 << "\n";
+        std::cout << "matches/pattern:    " << static_cast<double>(matched) / (2 * queryCount) << std::endl;
+    }
+
+    // Suffix queries on the last three characters of a word, through the suffix index and by scanning every word,
+    // and longest-prefix matches of words with a tail appended.
+    {
+        RadixTree dictionary = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        double indexNs = nanosecondsPerOp(sortedWords.size(), [&] {
+            dictionary.setSuffixIndex(true);
+        });
+        size_t queryCount = std::min<size_t>(lookups.size(), 2000);
+        size_t scanCount = std::min<size_t>(queryCount, 20);
+        std::vector<std::string> suffixes;
+        std::vector<std::string> texts;
+        for (size_t i = 0; i < queryCount; ++i) {
+            suffixes.push_back(lookups[i].substr(lookups[i].size() - std::min<size_t>(lookups[i].size(), 3)));
+            texts.push_back(lookups[i] + "/tail");
+        }
+        size_t matched = 0;
+        double suffixNs = nanosecondsPerOp(queryCount, [&] {
+            for (const auto& suffix : suffixes) {
+                matched += dictionary.endsWith(suffix, [](const std::string&) {});
+            }
+        });
+        size_t scanned = 0;
+        double scanNs = nanosecondsPerOp(scanCount, [&] {
+            for (size_t i = 0; i < scanCount; ++i) {
+                const std::string& suffix = suffixes[i];
+                for (const std::string& word : dictionary) {
+                    scanned += word.size() >= suffix.size() && word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0;
+                }
+            }
+        });
+        size_t longest = 0;
+        double prefixNs = nanosecondsPerOp(queryCount, [&] {
+            for (const auto& text : texts) {
+                longest += dictionary.longestPrefixOf(text).value_or(std::string_view()).size();
+            }
+        });
+        if (longest == 0 || scanned == 0) {
+            std::cerr << "suffix: no matches\n";
+            return 1;
+        }
+        std::cout << "[suffix]\n";
+        std::cout << "index build ns/key: " << indexNs << "\n";
+        std::cout << "endsWith us/query:  " << suffixNs / 1000 << "\n";
+        std::cout << "full scan us/query: " << scanNs / 1000 << "\n";
+        std::cout << "matches/query:      " << static_cast<double>(matched) / queryCount << "\n";
+        std::cout << "longestPrefixOf ns: " << prefixNs << std::endl;
+    }
+
+    // Applying an hourly delta: a tenth of the words are new, the rest overlap with the base dictionary.
+    {
+        RadixTree base = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        std::vector<std::string> deltaWords(sortedWords.begin(), sortedWords.begin() + sortedWords.size() / 10);
+        for (size_t i = 0; i < deltaWords.size(); i += 2) {
+            deltaWords[i] += '+';
+        }
+        std::sort(deltaWords.begin(), deltaWords.end());
+        RadixTree delta = RadixTree::fromSorted(deltaWords.begin(), deltaWords.end());
+
+        double mergeNs = nanosecondsPerOp(deltaWords.size(), [&] {
+            base += delta;
+        });
+        double subtractNs = nanosecondsPerOp(deltaWords.size(), [&] {
+            base -= delta;
+        });
+        double intersectNs = nanosecondsPerOp(sortedWords.size(), [&] {
+            base &= delta;
+        });
+        std::cout << "[set operations]\n";
+        std::cout << "+= ns/delta word:   " << mergeNs << "\n";
+        std::cout << "-= ns/delta word:   " << subtractNs << "\n";
+        std::cout << "&= ns/base word:    " << intersectNs << std::endl;
+    }
+
+    // Deduplication with about 40% repeated words: catching insert's exception versus tryInsert and insertBatch.
+    {
+        std::vector<std::string> stream(lookups.begin(), lookups.begin() + lookups.size() * 3 / 5);
+        stream.insert(stream.end(), lookups.begin(), lookups.begin() + lookups.size() * 2 / 5);
+        std::shuffle(stream.begin(), stream.end(), std::mt19937(3));
+        double throwingNs = 0;
+        double tryNs = 0;
+        double batchNs = 0;
+        size_t unique = 0;
+        {
+            RadixTree dedup;
+            throwingNs = nanosecondsPerOp(stream.size(), [&] {
+                for (const auto& word : stream) {
+                    try {
+                        dedup.insert(word);
+                    }
+                    catch (const MyException&) {
+                    }
+                }
+            });
+            unique = dedup.size();
+        }
+        {
+            RadixTree dedup;
+            tryNs = nanosecondsPerOp(stream.size(), [&] {
+                for (const auto& word : stream) {
+                    dedup.tryInsert(word);
+                }
+            });
+        }
+        {
+            RadixTree dedup;
+            size_t added = 0;
+            batchNs = nanosecondsPerOp(stream.size(), [&] {
+                added = dedup.insertBatch(stream);
+            });
+            if (added != unique) {
+                std::cerr << "dedup: wrong count\n";
+                return 1;
+            }
+        }
+        std::cout << "[dedup]\n";
+        std::cout << "insert+catch ns/op: " << throwingNs << "\n";
+        std::cout << "tryInsert ns/op:    " << tryNs << "\n";
+        std::cout << "insertBatch ns/op:  " << batchNs << std::endl;
+    }
+
+    // Scaling of the parallel build and of copies and merges of large trees with the thread count.
+    // Speedups are bounded by the hardware threads reported below; with fewer, extra threads only add switching.
+    {
+        std::vector<std::string> deltaWords = makeCorpus(keyCount / 2, 11);
+        for (auto& word : deltaWords) {
+            word += '+';
+        }
+        RadixTree delta;
+        for (const auto& word : deltaWords) {
+            delta.insert(word);
+        }
+        std::cout << "[parallel scaling]\n";
+        std::cout << "hardware threads:   " << std::thread::hardware_concurrency() << "\n";
+        std::cout << "threads  build ns/key  copy ns/key  += ns/delta word\n";
+        for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+            RadixTree::setThreadCount(threads);
+            RadixTree built;
+            double buildNs = nanosecondsPerOp(words.size(), [&] {
+                built = RadixTree::buildParallel(words, threads);
+            });
+            RadixTree copied;
+            double copyNs = nanosecondsPerOp(words.size(), [&] {
+                copied = built;
+            });
+            double mergeNs = nanosecondsPerOp(deltaWords.size(), [&] {
+                copied += delta;
+            });
+            if (copied.size() != built.size() + delta.size()) {
+                std::cerr << "parallel scaling: wrong merged size\n";
+                return 1;
+            }
+            std::cout << std::setw(7) << threads << std::setw(14) << buildNs << std::setw(13) << copyNs << std::setw(18) << mergeNs << "\n";
+        }
+        std::cout << std::flush;
+        RadixTree::setThreadCount(0);
+    }
+
+    // Keys with a payload: a word set next to a hash map of payloads versus one map holding both.
+    {
+        size_t bytesBefore = liveBytes;
+        {
+            RadixTree keys;
+            std::unordered_map<std::string, std::uint32_t> payloads;
+            for (size_t i = 0; i < words.size(); ++i) {
+                keys.insert(words[i]);
+                payloads.emplace(words[i], static_cast<std::uint32_t>(i));
+            }
+            size_t pairBytes = liveBytes - bytesBefore;
+            std::cout << "[payloads]\n";
+            std::cout << "tree+hash bytes/key:" << static_cast<double>(pairBytes) / words.size() << "\n";
+        }
+        bytesBefore = liveBytes;
+        RadixMap<std::string, std::uint32_t> map;
+        for (size_t i = 0; i < words.size(); ++i) {
+            map.try_emplace(words[i], static_cast<std::uint32_t>(i));
+        }
+        size_t mapBytes = liveBytes - bytesBefore;
+        size_t mapHits = 0;
+        double mapHitNs = nanosecondsPerOp(lookups.size(), [&] {
+            for (const auto& word : lookups) {
+                mapHits += map.find(word) != nullptr;
+            }
+        });
+        if (mapHits != lookups.size()) {
+            std::cerr << "Map lookup mismatch" << std::endl;
+            return 1;
+        }
+        std::cout << "RadixMap bytes/key: " << static_cast<double>(mapBytes) / words.size() << "\n";
+        std::cout << "RadixMap find ns/op:" << mapHitNs << std::endl;
+    }
+
+    // Cold start: saving once, then mapping the file instead of rebuilding the tree.
+    {
+        RadixTree savedTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        double saveMs = nanosecondsPerOp(1000000, [&] {
+            savedTree.save("bench.rdx");
+        });
+        std::unique_ptr<MappedRadixTree> mappedTree;
+        double openMs = nanosecondsPerOp(1000000, [&] {
+            mappedTree = std::make_unique<MappedRadixTree>("bench.rdx");
+        });
+        size_t mappedFound = 0;
+        double mappedHitNs = nanosecondsPerOp(lookups.size(), [&] {
+            for (const auto& word : lookups) {
+                mappedFound += mappedTree->search(word);
+            }
+        });
+        std::remove("bench.rdx");
+        if (mappedFound != lookups.size()) {
+            std::cerr << "Mapped lookup mismatch" << std::endl;
+            return 1;
+        }
+        std::cout << "[mapped]\n";
+        std::cout << "save ms:            " << saveMs << "\n";
+        std::cout << "open ms:            " << openMs << "\n";
+        std::cout << "search hit ns/op:   " << mappedHitNs << std::endl;
+    }
+
+    // Freezing a dictionary that won't change any more. Overhead is what the frozen tree takes beyond the raw key bytes.
+    {
+        RadixTree sourceTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        std::unique_ptr<FrozenRadixTree> frozenTree;
+        double freezeMs = nanosecondsPerOp(1000000, [&] {
+            frozenTree = std::make_unique<FrozenRadixTree>(sourceTree.freeze());
+        });
+        size_t keyBytes = 0;
+        for (const auto& word : sortedWords) {
+            keyBytes += word.size();
+        }
+        size_t frozenFound = 0;
+        double frozenHitNs = nanosecondsPerOp(lookups.size(), [&] {
+            for (const auto& word : lookups) {
+                frozenFound += frozenTree->search(word);
+            }
+        });
+        if (frozenFound != lookups.size()) {
+            std::cerr << "Frozen lookup mismatch" << std::endl;
+            return 1;
+        }
+        size_t visited = 0;
+        double frozenIterateNs = nanosecondsPerOp(sortedWords.size(), [&] {
+            frozenTree->forEachWithPrefix("", [&](const std::string&) { ++visited; });
+        });
+        double keyCount = static_cast<double>(sortedWords.size());
+        std::cout << "[frozen]\n";
+        std::cout << "freeze ms:          " << freezeMs << "\n";
+        std::cout << "raw key bytes/key:  " << keyBytes / keyCount << "\n";
+        std::cout << "bytes/key:          " << frozenTree->memoryUsage() / keyCount << "\n";
+        std::cout << "overhead bytes/key: " << (static_cast<double>(frozenTree->memoryUsage()) - keyBytes) / keyCount << "\n";
+        std::cout << "search hit ns/op:   " << frozenHitNs << "\n";
+        std::cout << "iterate ns/key:     " << frozenIterateNs << std::endl;
+    }
+
+    // Read-mostly sharing: reader threads query the concurrent tree while one writer keeps inserting and removing.
+    // Each run lasts a fixed time and reports the lookups completed by all readers together.
+    {
+        ConcurrentRadixTree sharedTree;
+        for (const auto& word : words) {
+            sharedTree.insert(word);
+        }
+        std::cout << "[concurrent]\n";
+        unsigned maxReaders = std::max(4u, std::thread::hardware_concurrency());
+        for (unsigned readerCount = 1; readerCount <= maxReaders; readerCount *= 2) {
+            std::atomic<bool> stop(false);
+            std::atomic<size_t> totalReads(0);
+            size_t writes = 0;
+            std::vector<std::thread> readers;
+            for (unsigned r = 0; r < readerCount; ++r) {
+                readers.emplace_back([&, r] {
+                    size_t reads = 0;
+                    for (size_t i = r; !stop.load(std::memory_order_relaxed); i += readerCount) {
+                        sharedTree.search(lookups[i % lookups.size()]);
+                        ++reads;
+                    }
+                    totalReads += reads;
+                });
+            }
+            auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+                const std::string& word = misses[writes % misses.size()];
+                sharedTree.insert(word);
+                sharedTree.remove(word);
+                writes += 2;
+            }
+            stop = true;
+            for (auto& reader : readers) {
+                reader.join();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << readerCount << " readers Mreads/s:  " << totalReads / seconds / 1e6
+                      << " (writer " << writes / seconds / 1e3 << "k writes/s)\n";
+        }
+
+        // Handing a consistent dictionary to each request batch: a deep copy versus a shared snapshot.
+        RadixTree plainTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        double deepCopyNs = nanosecondsPerOp(1, [&] {
+            RadixTree copy = plainTree;
+        });
+        size_t snapshotWords = 0;
+        double snapshotNs = nanosecondsPerOp(1000, [&] {
+            for (int i = 0; i < 1000; ++i) {
+                snapshotWords += sharedTree.snapshot().size();
+            }
+        });
+        size_t bytesBefore = liveBytes;
+        ConcurrentRadixTree::Snapshot held = sharedTree.snapshot();
+        size_t churn = std::min<size_t>(misses.size(), 10000);
+        for (size_t i = 0; i < churn; ++i) {
+            sharedTree.insert(misses[i]);
+        }
+        double divergedBytes = static_cast<double>(liveBytes - bytesBefore) / churn;
+        std::cout << "RadixTree copy ms:  " << deepCopyNs / 1e6 << "\n";
+        std::cout << "snapshot ns:        " << snapshotNs << "\n";
+        std::cout << "bytes/write kept:   " << divergedBytes << " (" << held.size() << " words in snapshot)" << std::endl;
+    }
+
+    // Durable tree on the local file system: write throughput with a sync per change, with group commit from
+    // several writers and with a background flush, then checkpoint and recovery time.
+    {
+        const char* directory = "bench_durable";
+        std::filesystem::remove_all(directory);
+        std::cout << "[durability]\n";
+        size_t syncedWrites = std::min<size_t>(words.size(), 2000);
+        for (unsigned writerCount : {1u, 8u}) {
+            DurableRadixTree durable(directory);
+            double seconds = nanosecondsPerOp(1, [&] {
+                std::vector<std::thread> writers;
+                for (unsigned w = 0; w < writerCount; ++w) {
+                    writers.emplace_back([&, w] {
+                        for (size_t i = w; i < syncedWrites; i += writerCount) {
+                            durable.insert(words[i]);
+                        }
+                    });
+                }
+                for (auto& writer : writers) {
+                    writer.join();
+                }
+            }) / 1e9;
+            std::cout << "synced, " << writerCount << " writer" << (writerCount > 1 ? "s" : " ") << " k/s: " << syncedWrites / seconds / 1e3 << "\n";
+            std::filesystem::remove_all(directory);
+        }
+
+        size_t durableWords = std::min<size_t>(words.size(), 200000);
+        size_t tailWords = durableWords / 10;
+        DurableRadixTree::Options options;
+        options.synchronous = false;
+        options.checkpointBytes = 0;
+        double checkpointMs = 0;
+        {
+            DurableRadixTree durable(directory, options);
+            double asyncNs = nanosecondsPerOp(durableWords, [&] {
+                for (size_t i = 0; i < durableWords; ++i) {
+                    durable.insert(words[i]);
+                }
+                durable.sync();
+            });
+            std::cout << "background flush k/s: " << 1e6 / asyncNs << "\n";
+            checkpointMs = nanosecondsPerOp(1, [&] {
+                durable.checkpoint();
+            }) / 1e6;
+            for (size_t i = 0; i < tailWords; ++i) {
+                durable.insert(misses[i]);
+            }
+        }
+        size_t recoveredWords = 0;
+        double recoveryMs = nanosecondsPerOp(1, [&] {
+            DurableRadixTree durable(directory);
+            recoveredWords = durable.size();
+        }) / 1e6;
+        if (recoveredWords != durableWords + tailWords) {
+            std::cerr << "durability: wrong recovered size\n";
+            return 1;
+        }
+        std::cout << "checkpoint ms:      " << checkpointMs << " (" << durableWords << " words)\n";
+        std::cout << "recovery ms:        " << recoveryMs << " (checkpoint + " << tailWords << " logged words)" << std::endl;
+        std::filesystem::remove_all(directory);
+    }
+
+    // Label lengths of dictionary words, path segments and whole URLs sharing a long prefix.
+    std::cout << "[prefix kernel]\n";
+    benchmarkPrefixKernel("1-8 bytes    ", 1, 8);
+    benchmarkPrefixKernel("8-32 bytes   ", 8, 32);
+    benchmarkPrefixKernel("32-128 bytes ", 32, 128);
+    benchmarkPrefixKernel("128-512 bytes", 128, 512);
+    std::cout << std::flush;
+
+    return 0;
+}
@@ -1,10 +1,49 @@
 #include "RadixTree.h"
+#include "MappedRadixTree.h"
+#include "FrozenRadixTree.h"
+#include "ConcurrentRadixTree.h"
+#include "DurableRadixTree.h"
+#include "PrefixMatch.h"
+#include "RadixFormat.h"
+#include "RadixMap.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <filesystem>
 #include <cassert>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <string_view>
+#include <cstdlib>
+#include <new>
 
 using namespace RadixTreeProject;
 
+// Counts heap allocations, so the tests can check which operations allocate.
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
 void log(std::ostream& os, const std::string& message) {
     std::cout << message << std::endl;
     os << message << std::endl;
@@ -42,6 +81,30 @@ int main() {
         pTree.insert("cat");
         assert(rTree == tTree);
         log(logFile, "Cloning operator test passed.\n");
+
+        // A moved-from tree is left empty and can still be used.
+        RadixTree movedFrom = rTree;
+        size_t allocationsBeforeMove = allocationCount;
+        RadixTree movedTree = std::move(movedFrom);
+        RadixTree movedAgain = std::move(movedFrom);
+        movedAgain = std::move(movedTree);
+        movedTree = std::move(movedAgain);
+        assert(allocationCount == allocationsBeforeMove);
+        assert(movedTree == rTree && movedFrom.empty() && !movedFrom.search("toast") && movedFrom.begin() == movedFrom.end());
+        RadixTree movedCopy = movedFrom;
+        movedCopy += movedFrom;
+        assert(movedCopy.empty() && movedCopy == movedFrom);
+        movedFrom = movedTree;
+        movedFrom.insert("toe");
+        assert(movedFrom.size() == rTree.size() + 1 && movedTree == rTree);
+        RadixTree arenaSource(RadixTree::AllocationMode::Arena);
+        arenaSource.insert("toast");
+        RadixTree arenaTarget;
+        arenaTarget = std::move(arenaSource);
+        arenaSource.insert("toaster");
+        arenaSource = arenaTarget;
+        assert(arenaSource.size() == 1 && arenaSource.search("toast") && arenaTarget.search("toast"));
+        log(logFile, "Move test passed.\n");
         assert(rTree != pTree);
         assert(rTree > pTree);
         assert(pTree < tTree);
@@ -70,6 +133,669 @@ int main() {
         log(logFile, "Tree after clearing:\n");
         log(logFile, rTree.toString() + "\n");
 
+        RadixTree wideTree;
+        for (int c = 1; c < 256; ++c) {
+            wideTree.insert(std::string("x") + static_cast<char>(c));
+        }
+        for (int c = 1; c < 256; ++c) {
+            assert(wideTree.search(std::string("x") + static_cast<char>(c)));
+        }
+        for (int c = 255; c > 1; --c) {
+            wideTree.remove(std::string("x") + static_cast<char>(c));
+        }
+        assert(wideTree.search(std::string("x") + static_cast<char>(1)));
+        assert(!wideTree.search(std::string("x") + static_cast<char>(2)));
+        log(logFile, "Node growing and shrinking test passed.\n");
+
+        RadixTree arenaTree(RadixTree::AllocationMode::Arena);
+        arenaTree.insert("toast");
+        arenaTree.insert("toaster");
+        arenaTree.insert("a rather long word that doesn't fit into a small string");
+        arenaTree.remove("toaster");
+        arenaTree.insert("toasting");
+        assert(arenaTree.search("toasting") && !arenaTree.search("toaster"));
+        RadixTree arenaCopy = arenaTree;
+        !arenaTree;
+        assert(arenaCopy.search("a rather long word that doesn't fit into a small string"));
+        arenaTree = arenaCopy;
+        assert(arenaTree == arenaCopy);
+        log(logFile, "Arena allocation test passed.\n");
+
+        std::vector<std::string> sortedWords = {"", "car", "cat", "cats", "toast", "toaster", "toasting", "toe"};
+        RadixTree insertedTree;
+        for (const auto& word : sortedWords) {
+            insertedTree.insert(word);
+        }
+        RadixTree bulkTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        assert(bulkTree == insertedTree);
+        RadixTree::Builder builder(RadixTree::AllocationMode::Arena);
+        builder.add("b");
+        bool rejected = false;
+        try {
+            builder.add("a");
+        }
+        catch (const MyException&) {
+            rejected = true;
+        }
+        assert(rejected);
+        log(logFile, "Sorted bulk loading test passed.\n");
+
+        bulkTree.save("testtree.rdx");
+        {
+            MappedRadixTree mappedTree("testtree.rdx");
+            assert(mappedTree.size() == sortedWords.size());
+            for (const auto& word : sortedWords) {
+                assert(mappedTree.search(word));
+            }
+            assert(!mappedTree.search("toas") && !mappedTree["cart"]);
+            assert(mappedTree.hasPrefix("toa") && !mappedTree.hasPrefix("tx"));
+            std::string prefixed;
+            mappedTree.forEachWithPrefix("toas", [&](const std::string& word) {
+                prefixed += word + " ";
+            });
+            assert(prefixed == "toast toaster toasting ");
+            assert(mappedTree.forEachWithPrefix("", [](const std::string&) {}, 3) == 3);
+            // Saving over a mapped file replaces it, the mapping keeps the old contents.
+            pTree.save("testtree.rdx");
+            assert(mappedTree.size() == sortedWords.size() && mappedTree.search("toasting"));
+            MappedRadixTree remapped("testtree.rdx");
+            assert(remapped.size() == pTree.size() && !remapped.search("toasting"));
+            MappedRadixTree takenOver = std::move(remapped);
+            assert(takenOver.size() == pTree.size() && remapped.size() == 0 && !remapped.search("car") && !remapped.hasPrefix(""));
+            assert(remapped.forEachWithPrefix("", [](const std::string&) {}) == 0);
+            remapped = std::move(takenOver);
+            assert(remapped.search("car") && takenOver.size() == 0);
+        }
+        std::remove("testtree.rdx");
+
+        // Damaged files are rejected when they are opened, instead of being followed out of bounds.
+        bulkTree.save("testbad.rdx");
+        std::string savedBytes;
+        {
+            std::ifstream savedFile("testbad.rdx", std::ios::binary);
+            savedBytes.assign(std::istreambuf_iterator<char>(savedFile), std::istreambuf_iterator<char>());
+        }
+        auto rejectsDamage = [&](const std::function<void(RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>&, std::string&)>& damage) {
+            RadixFormat::FileHeader header;
+            std::memcpy(&header, savedBytes.data(), sizeof(header));
+            std::vector<RadixFormat::FileNode> nodes(header.nodeCount);
+            std::memcpy(nodes.data(), savedBytes.data() + header.nodesOffset, nodes.size() * sizeof(RadixFormat::FileNode));
+            std::string rest = savedBytes.substr(header.keysOffset);
+            damage(header, nodes, rest);
+            {
+                std::ofstream damagedFile("testbad.rdx", std::ios::binary | std::ios::trunc);
+                damagedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                damagedFile.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(RadixFormat::FileNode));
+                damagedFile.write(rest.data(), rest.size());
+            }
+            size_t rejections = 0;
+            try {
+                MappedRadixTree damagedTree("testbad.rdx");
+            }
+            catch (const MyException&) {
+                ++rejections;
+            }
+            ConcurrentRadixTree damagedShared;
+            try {
+                damagedShared.load("testbad.rdx");
+            }
+            catch (const MyException&) {
+                ++rejections;
+            }
+            return rejections == 2;
+        };
+        assert(!rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>&, std::string&) {}));
+        assert(rejectsDamage([](RadixFormat::FileHeader& header, std::vector<RadixFormat::FileNode>&, std::string&) {
+            header.nodeCount = UINT64_MAX / sizeof(RadixFormat::FileNode) + 2;
+        }));
+        assert(rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>& nodes, std::string&) {
+            nodes[0].firstChild = 1000;
+        }));
+        assert(rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>& nodes, std::string&) {
+            nodes[1].firstChild = 1;
+            nodes[1].childCount = 1;
+        }));
+        assert(rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>& nodes, std::string&) {
+            nodes[2].labelOffset = UINT64_MAX - 1;
+        }));
+        assert(rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>& nodes, std::string&) {
+            nodes[2].labelLength = 0;
+        }));
+        assert(rejectsDamage([](RadixFormat::FileHeader&, std::vector<RadixFormat::FileNode>&, std::string& rest) {
+            rest.pop_back();
+        }));
+        std::remove("testbad.rdx");
+        log(logFile, "Saving and memory mapping test passed.\n");
+
+        {
+            FrozenRadixTree frozenTree = bulkTree.freeze();
+            assert(frozenTree.size() == sortedWords.size());
+            for (const auto& word : sortedWords) {
+                assert(frozenTree.search(word));
+            }
+            assert(!frozenTree.search("toas") && !frozenTree["cart"] && !frozenTree.search("toastings"));
+            assert(frozenTree.hasPrefix("toa") && frozenTree.hasPrefix("") && !frozenTree.hasPrefix("tx"));
+            std::vector<std::string> frozenWords;
+            frozenTree.forEachWithPrefix("", [&](const std::string& word) {
+                frozenWords.push_back(word);
+            });
+            assert(frozenWords == sortedWords);
+            std::string prefixed;
+            frozenTree.forEachWithPrefix("toas", [&](const std::string& word) {
+                prefixed += word + " ";
+            });
+            assert(prefixed == "toast toaster toasting ");
+            assert(frozenTree.forEachWithPrefix("ca", [](const std::string&) {}, 2) == 2);
+
+            FrozenRadixTree emptyFrozen = RadixTree().freeze();
+            assert(emptyFrozen.size() == 0 && !emptyFrozen.search("") && !emptyFrozen.hasPrefix(""));
+            frozenTree = std::move(emptyFrozen);
+            assert(!frozenTree.search("cat"));
+        }
+        log(logFile, "Freezing test passed.\n");
+
+        std::vector<std::string> iterated(bulkTree.begin(), bulkTree.end());
+        assert(iterated == sortedWords);
+        RadixTree::ConstIterator position = wideTree.begin();
+        assert(*position++ == std::string("x") + static_cast<char>(1));
+        assert(position == wideTree.end());
+        assert(emptyTree.begin() == emptyTree.end());
+        log(logFile, "Ordered iteration test passed.\n");
+
+        assert(bulkTree.countWithPrefix("") == sortedWords.size());
+        assert(bulkTree.countWithPrefix("toas") == 3 && insertedTree.countWithPrefix("toas") == 3);
+        assert(bulkTree.countWithPrefix("ca") == 3 && bulkTree.countWithPrefix("cab") == 0);
+        assert(bulkTree.hasPrefix("toe") && !bulkTree.hasPrefix("toex"));
+        insertedTree.remove("cats");
+        try {
+            insertedTree.insert("car");
+        }
+        catch (const MyException&) {
+        }
+        assert(insertedTree.countWithPrefix("ca") == 2);
+        std::string completions;
+        size_t reported = bulkTree.forEachWithPrefix("t", [&](const std::string& word) {
+            completions += word + " ";
+        }, 2);
+        assert(reported == 2 && completions == "toast toaster ");
+        log(logFile, "Prefix query test passed.\n");
+
+        std::vector<std::string> batchWords = {"toaster", "toa", "", "toastingly", "cat", "zebra", "toe", "c"};
+        std::vector<bool> batchFound;
+        bulkTree.searchBatch(batchWords, batchFound);
+        assert(batchFound.size() == batchWords.size());
+        for (size_t i = 0; i < batchWords.size(); ++i) {
+            assert(batchFound[i] == bulkTree.search(batchWords[i]));
+        }
+        wideTree.searchBatch(std::vector<std::string>(), batchFound);
+        assert(batchFound.empty());
+        log(logFile, "Batch search test passed.\n");
+
+        using Matches = std::vector<std::pair<std::string, size_t>>;
+        assert(bulkTree.searchWithin("toast", 0) == Matches({{"toast", 0}}));
+        assert(bulkTree.searchWithin("tost", 1) == Matches({{"toast", 1}}));
+        assert(bulkTree.searchWithin("cat", 1) == Matches({{"cat", 0}, {"car", 1}, {"cats", 1}}));
+        assert(bulkTree.searchWithin("cat", 1, 2) == Matches({{"cat", 0}, {"car", 1}}));
+        assert(bulkTree.searchWithin("toasted", 2) == Matches({{"toaster", 1}, {"toast", 2}}));
+        assert(bulkTree.searchWithin("xy", 2) == Matches({{"", 2}}));
+        assert(bulkTree.searchWithin("zebra", 1).empty() && bulkTree.searchWithin("cat", 5, 0).empty());
+        // A distance no word can reach finds every word, however large it is.
+        for (size_t unbounded : {size_t(10), SIZE_MAX - 2, SIZE_MAX - 1, SIZE_MAX}) {
+            assert(bulkTree.searchWithin("abc", unbounded) == bulkTree.searchWithin("abc", 10));
+            assert(bulkTree.searchWithin("abc", unbounded).size() == sortedWords.size());
+        }
+        log(logFile, "Fuzzy search test passed.\n");
+
+        std::vector<std::string> globbed;
+        auto collect = [&](const std::string& word) { globbed.push_back(word); };
+        assert(bulkTree.match("toast*", collect) == 3 && globbed == std::vector<std::string>({"toast", "toaster", "toasting"}));
+        globbed.clear();
+        assert(bulkTree.match("ca?", collect) == 2 && globbed == std::vector<std::string>({"car", "cat"}));
+        globbed.clear();
+        assert(bulkTree.match("[a-c]*", collect, 2) == 2 && globbed == std::vector<std::string>({"car", "cat"}));
+        globbed.clear();
+        assert(bulkTree.match("*[!t]", collect) == 5 && globbed == std::vector<std::string>({"car", "cats", "toaster", "toasting", "toe"}));
+        globbed.clear();
+        assert(bulkTree.match("t*s*g", collect) == 1 && globbed == std::vector<std::string>({"toasting"}));
+        assert(bulkTree.match("", collect) == 1 && bulkTree.match("*", collect) == sortedWords.size());
+        assert(bulkTree.match("c\\at", collect) == 1 && bulkTree.match("toast?", collect) == 0);
+        bool badPattern = false;
+        try {
+            bulkTree.match("[a-c", collect);
+        }
+        catch (const MyException&) {
+            badPattern = true;
+        }
+        assert(badPattern);
+        log(logFile, "Glob match test passed.\n");
+
+        // Lookups through views into a larger buffer never allocate, inserts allocate only the new nodes.
+        RadixTree countedTree;
+        countedTree.insert("toast");
+        countedTree.insert("toaster");
+        std::string buffer = "toaster toasting toasted";
+        std::string_view token(buffer.data(), 7);
+        size_t allocationsBefore = allocationCount;
+        assert(countedTree.search(token) && countedTree[token] && !countedTree.search(token.substr(0, 4)));
+        assert(countedTree.hasPrefix(token.substr(0, 6)) && countedTree.countWithPrefix(token.substr(0, 3)) == 2);
+        assert(allocationCount == allocationsBefore);
+        countedTree.insert(std::string_view(buffer).substr(8, 8));
+        assert(allocationCount == allocationsBefore + 1);
+        countedTree.insert(std::string_view(buffer).substr(17));
+        assert(allocationCount == allocationsBefore + 3);
+        assert(countedTree.search("toasting") && countedTree.search("toasted") && countedTree.size() == 4);
+        log(logFile, "String view and allocation test passed.\n");
+
+        // Every mismatch position around the 16 and 32 byte vector widths, and the full-length match.
+        std::string longLabel(100, 'x');
+        for (size_t length : {0, 1, 15, 16, 17, 31, 32, 33, 64, 100}) {
+            for (size_t mismatch = 0; mismatch <= length; ++mismatch) {
+                std::string other = longLabel;
+                if (mismatch < length) {
+                    other[mismatch] = 'y';
+                }
+                assert(PrefixMatch::commonPrefixLength(longLabel.data(), other.data(), length) == mismatch);
+                assert(PrefixMatch::commonPrefixLengthVector(longLabel.data(), other.data(), length) == mismatch);
+            }
+        }
+        unsigned char childKeys[16] = {'a', 'c', 'e', 'g', 'i', 'k', 'm', 'o', 'q', 's', 'u', 'w', 'y', 0, 0, 0};
+        assert(PrefixMatch::findKey16(childKeys, 13, 'y') == 12 && PrefixMatch::findKey16(childKeys, 13, 'b') == -1);
+        assert(PrefixMatch::findKey16(childKeys, 13, 0) == -1 && PrefixMatch::findKey16(childKeys, 16, 0) == 13);
+        RadixTree urlTree;
+        urlTree.insert("https://example.com/static/images/logo.png");
+        urlTree.insert("https://example.com/static/images/icon.png");
+        urlTree.insert("https://example.com/static/scripts/app.js");
+        assert(urlTree.search("https://example.com/static/images/icon.png") && !urlTree.search("https://example.com/static/images/"));
+        assert(urlTree.countWithPrefix("https://example.com/static/i") == 2);
+        log(logFile, "Label matching kernel test passed.\n");
+
+        assert(bulkTree.size() == sortedWords.size() && !bulkTree.empty());
+        assert(emptyTree.size() == 0 && emptyTree.empty());
+        assert(!(bulkTree > bulkTree) && bulkTree >= bulkTree && bulkTree <= bulkTree);
+        assert(insertedTree < bulkTree && bulkTree != insertedTree);
+        log(logFile, "Size test passed.\n");
+
+        // "toe" splits "toast" into "to" + "ast": root -> to -> {ast -> {er, ing}, e}.
+        RadixTree shapeTree;
+        for (const char* word : {"toast", "toaster", "toasting", "toe"}) {
+            shapeTree.insert(word);
+        }
+        RadixTree::Statistics shape = shapeTree.statistics();
+        assert(shape.nodeCount == 6 && shape.wordCount == 4 && shape.labelBytes == 11);
+        assert(shape.depthHistogram == std::vector<size_t>({1, 1, 2, 2}));
+        assert(shape.fanOutHistogram == std::vector<size_t>({3, 1, 2}));
+        assert(shape.labelLengthHistogram == std::vector<size_t>({1, 1, 2, 2}));
+        assert(shape.nodesByType[0] == 6 && shape.bytesByType[0] > 0 && shape.nodesByType[1] == 0);
+        assert(shape.splits == (RadixTree::instrumented() ? 1 : 0) && shape.merges == 0);
+        assert(RadixTree().statistics().nodeCount == 1);
+        assert(shapeTree.search("toe") && !shapeTree.search("to"));
+        RadixTree::OperationStatistics operations = RadixTree::operationStatistics();
+        if (RadixTree::instrumented()) {
+            assert(operations.calls[RadixTree::OperationStatistics::Search] >= 2);
+            assert(operations.calls[RadixTree::OperationStatistics::Insert] >= 4);
+        }
+        else {
+            assert(operations.calls[RadixTree::OperationStatistics::Search] == 0);
+        }
+        log(logFile, "Statistics test passed.\n");
+
+        // Removing "toe" leaves "to" with only "ast" below it, so the two are joined back into "toast".
+        shapeTree.remove("toe");
+        RadixTree unsplitTree;
+        for (const char* word : {"toast", "toaster", "toasting"}) {
+            unsplitTree.insert(word);
+        }
+        assert(shapeTree == unsplitTree && shapeTree.statistics().nodeCount == 4);
+        assert(shapeTree.statistics().merges == (RadixTree::instrumented() ? 1 : 0));
+        shapeTree.remove("toast");
+        shapeTree.remove("toaster");
+        assert(shapeTree.statistics().nodeCount == 2 && shapeTree.search("toasting") && !shapeTree.hasPrefix("toaste"));
+        RadixTree differenceTree = unsplitTree;
+        differenceTree.insert("toe");
+        RadixTree removedWords;
+        removedWords.insert("toe");
+        removedWords.insert("toaster");
+        differenceTree -= removedWords;
+        unsplitTree.remove("toaster");
+        assert(differenceTree == unsplitTree && differenceTree.statistics().nodeCount == 3);
+
+        RadixTree churnedTree(RadixTree::AllocationMode::Arena);
+        for (int i = 0; i < 200; ++i) {
+            churnedTree.insert("key" + std::to_string(i));
+        }
+        for (int i = 0; i < 200; i += 3) {
+            churnedTree.remove("key" + std::to_string(i));
+        }
+        RadixTree::Statistics beforeCompact = churnedTree.statistics();
+        churnedTree.compact();
+        RadixTree::Statistics afterCompact = churnedTree.statistics();
+        assert(churnedTree.size() == 133 && churnedTree.search("key1") && !churnedTree.search("key3"));
+        assert(afterCompact.nodeCount == beforeCompact.nodeCount && afterCompact.depthHistogram == beforeCompact.depthHistogram);
+        churnedTree.insert("key3");
+        churnedTree.remove("key1");
+        assert(churnedTree.size() == 133 && churnedTree.search("key3"));
+        log(logFile, "Recompression and compaction test passed.\n");
+
+        RadixTree baseTree = RadixTree::fromSorted(sortedWords.begin(), sortedWords.end());
+        RadixTree deltaTree;
+        deltaTree.insert("cart");
+        deltaTree.insert("toast");
+        deltaTree.insert("zebra");
+        RadixTree unionTree = baseTree;
+        unionTree += deltaTree;
+        assert(unionTree.size() == sortedWords.size() + 2 && unionTree.search("cart") && unionTree.search("car"));
+        RadixTree commonTree = baseTree;
+        commonTree &= deltaTree;
+        assert(commonTree.size() == 1 && commonTree.search("toast"));
+        unionTree -= deltaTree;
+        assert(unionTree.size() == sortedWords.size() - 1 && !unionTree.search("toast") && unionTree.search("toaster"));
+        baseTree.merge(std::move(deltaTree));
+        assert(baseTree.size() == sortedWords.size() + 2 && baseTree.search("zebra") && deltaTree.empty());
+        log(logFile, "Set operation test passed.\n");
+
+        std::vector<std::string> shuffledWords;
+        for (int i = 0; i < 70000; ++i) {
+            shuffledWords.push_back(std::to_string(i * 7919 % 70001) + "w" + std::to_string(i % 13));
+        }
+        RadixTree sequentialTree;
+        for (const std::string& word : shuffledWords) {
+            sequentialTree.insert(word);
+        }
+        RadixTree parallelTree = RadixTree::buildParallel(shuffledWords, 4);
+        RadixTree parallelArenaTree = RadixTree::buildParallel(shuffledWords, 4, RadixTree::AllocationMode::Arena);
+        assert(parallelTree == sequentialTree && parallelArenaTree == sequentialTree && RadixTree::buildParallel(shuffledWords, 1) == sequentialTree);
+        shuffledWords.push_back(shuffledWords.front());
+        bool duplicateRejected = false;
+        try {
+            RadixTree::buildParallel(shuffledWords, 4);
+        }
+        catch (const std::exception&) {
+            duplicateRejected = true;
+        }
+        assert(duplicateRejected);
+        RadixTree::setThreadCount(4);
+        assert(RadixTree::threadCount() == 4);
+        RadixTree copiedTree = parallelArenaTree;
+        assert(copiedTree == sequentialTree && copiedTree.size() == 70000);
+        RadixTree evenTree;
+        for (int i = 0; i < 140000; i += 2) {
+            evenTree.insert(std::to_string(i * 7919 % 70001) + "w" + std::to_string(i % 13));
+        }
+        copiedTree -= evenTree;
+        parallelTree -= evenTree;
+        assert(copiedTree.size() == 35000 && parallelTree == copiedTree && !parallelTree.search(shuffledWords[2]) && parallelTree.search(shuffledWords[1]));
+        copiedTree += evenTree;
+        parallelTree += evenTree;
+        assert(copiedTree.size() == 70000 + 35000 && parallelTree == copiedTree && !(parallelTree == sequentialTree));
+        RadixTree::setThreadCount(0);
+        log(logFile, "Parallel build test passed.\n");
+
+        {
+            std::ofstream wordFile("testwords.txt", std::ios::binary);
+            for (const auto& word : sortedWords) {
+                wordFile << word << "\r\n";
+            }
+        }
+        RadixTree::LoadOptions loadOptions;
+        loadOptions.skipEmpty = false;
+        RadixTree loadedTree;
+        RadixTree::LoadStatistics loaded = loadedTree.loadFrom("testwords.txt", loadOptions);
+        assert(loaded.sorted && loaded.added == sortedWords.size() && loaded.duplicates == 0 && loadedTree == bulkTree);
+        loaded = loadedTree.loadFrom("testwords.txt");
+        assert(!loaded.sorted && loaded.added == 0 && loaded.duplicates == sortedWords.size() - 1 && loadedTree.size() == sortedWords.size());
+        std::remove("testwords.txt");
+        loadOptions.skipEmpty = true;
+        loadOptions.delimiter = ',';
+        loadOptions.bufferSize = 2;
+        std::istringstream wordStream("toe,cat,,car,toe,toasting");
+        RadixTree streamedTree;
+        loaded = streamedTree.loadFrom(wordStream, loadOptions);
+        assert(!loaded.sorted && loaded.added == 4 && loaded.duplicates == 1 && loaded.bytes == 25);
+        assert(streamedTree.size() == 4 && streamedTree.search("toasting") && streamedTree.search("toe") && !streamedTree.search(""));
+        loadOptions.skipDuplicates = false;
+        loadOptions.skipEmpty = false;
+        std::istringstream duplicateStream(",a,b,b,c");
+        RadixTree strictTree(RadixTree::AllocationMode::Arena);
+        bool duplicateThrown = false;
+        try {
+            strictTree.loadFrom(duplicateStream, loadOptions);
+        }
+        catch (const MyException&) {
+            duplicateThrown = true;
+        }
+        assert(duplicateThrown && strictTree.size() == 3 && strictTree.search("") && strictTree.search("b") && !strictTree.search("c"));
+        log(logFile, "Word list loading test passed.\n");
+
+        RadixTree tryTree;
+        assert(tryTree.tryInsert("toast") && tryTree.tryInsert("toaster") && !tryTree.tryInsert("toast"));
+        assert(tryTree.size() == 2 && tryTree.countWithPrefix("toast") == 2);
+        assert(!tryTree.tryRemove("toas") && !tryTree.tryRemove("toasters") && tryTree.tryRemove("toast") && !tryTree.tryRemove("toast"));
+        assert(tryTree.size() == 1 && tryTree.search("toaster"));
+        std::vector<std::string> insertedBatch = {"car", "cat", "car", "toaster", "cats"};
+        assert(tryTree.insertBatch(insertedBatch) == 3 && tryTree.size() == 4);
+        std::vector<std::string_view> removedBatch = {"cat", "ca", "cats", "cat", "toe"};
+        assert(tryTree.removeBatch(removedBatch) == 2 && tryTree.size() == 2 && tryTree.search("car") && !tryTree.search("cat"));
+        ConcurrentRadixTree tryShared;
+        assert(tryShared.tryInsert("car") && !tryShared.tryInsert("car") && !tryShared.tryRemove("cat") && tryShared.tryRemove("car"));
+        assert(tryShared.size() == 0);
+        log(logFile, "Non-throwing insert and remove test passed.\n");
+
+        RadixTree routes;
+        routes.insertBatch(std::vector<std::string>{"10.", "10.1.", "10.1.2.", "192.168."});
+        assert(routes.longestPrefixOf("10.1.2.7") == "10.1.2." && routes.longestPrefixOf("10.1.9.1") == "10.1.");
+        assert(routes.longestPrefixOf("10.") == "10." && !routes.longestPrefixOf("10") && !routes.longestPrefixOf("172.16.0.1"));
+        assert(!routes.longestPrefixOf(""));
+        routes.insert("");
+        assert(routes.longestPrefixOf("172.16.0.1") == "" && routes.longestPrefixOf("192.168.0.1") == "192.168.");
+        log(logFile, "Longest prefix test passed.\n");
+
+        // Every endsWith answer is checked against a scan of all words.
+        auto checkSuffixes = [](const RadixTree& tree) {
+            for (std::string suffix : {"", "t", "st", "er", "ing", "oe", "toaster", "x"}) {
+                std::vector<std::string> found;
+                tree.endsWith(suffix, [&](const std::string& word) {
+                    found.push_back(word);
+                });
+                std::vector<std::string> expected;
+                for (const std::string& word : tree) {
+                    if (word.size() >= suffix.size() && word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                        expected.push_back(word);
+                    }
+                }
+                std::sort(found.begin(), found.end());
+                assert(found == expected);
+            }
+        };
+        RadixTree suffixTree(RadixTree::AllocationMode::Arena);
+        bool suffixThrown = false;
+        try {
+            suffixTree.endsWith("t", [](const std::string&) {});
+        }
+        catch (const MyException&) {
+            suffixThrown = true;
+        }
+        assert(suffixThrown && !suffixTree.hasSuffixIndex());
+        suffixTree.insertBatch(std::vector<std::string>{"cat", "toast", "toe"});
+        suffixTree.setSuffixIndex(true);
+        suffixTree.insertBatch(sortedWords);
+        suffixTree.insert("roast");
+        suffixTree.remove("cats");
+        assert(suffixTree.hasSuffixIndex());
+        checkSuffixes(suffixTree);
+        std::string lastTwo;
+        assert(suffixTree.endsWith("st", [&](const std::string& word) {
+            lastTwo += word + " ";
+        }, 2) == 2 && lastTwo == "roast toast ");
+        suffixTree += streamedTree;
+        std::vector<std::string> droppedWords = {"car", "toe"};
+        suffixTree -= RadixTree::fromSorted(droppedWords.begin(), droppedWords.end());
+        checkSuffixes(suffixTree);
+        RadixTree suffixCopy = suffixTree;
+        suffixCopy &= bulkTree;
+        suffixCopy.compact();
+        assert(suffixCopy.hasSuffixIndex() && suffixCopy.size() == 5);
+        checkSuffixes(suffixCopy);
+        RadixTree indexedOther;
+        indexedOther.setSuffixIndex(true);
+        indexedOther.insert("yeast");
+        suffixCopy.merge(std::move(indexedOther));
+        assert(indexedOther.hasSuffixIndex() && indexedOther.empty());
+        suffixCopy.merge(RadixTree(bulkTree));
+        checkSuffixes(suffixCopy);
+        RadixTree suffixLoaded;
+        suffixLoaded.setSuffixIndex(true);
+        std::istringstream suffixStream("a\nbat\ncat\nbee\nat");
+        suffixLoaded.loadFrom(suffixStream);
+        assert(suffixLoaded.size() == 5);
+        checkSuffixes(suffixLoaded);
+        std::string endingAt;
+        suffixLoaded.endsWith("at", [&](const std::string& word) {
+            endingAt += word + " ";
+        });
+        assert(endingAt == "at bat cat ");
+        !suffixLoaded;
+        assert(suffixLoaded.hasSuffixIndex() && suffixLoaded.endsWith("", [](const std::string&) {}) == 0);
+        suffixTree.setSuffixIndex(false);
+        assert(!suffixTree.hasSuffixIndex());
+        log(logFile, "Suffix index test passed.\n");
+
+        ConcurrentRadixTree sharedTree;
+        for (const std::string& word : sortedWords) {
+            sharedTree.insert(word);
+        }
+        assert(sharedTree.size() == sortedWords.size() && sharedTree["toaster"] && !sharedTree["toa"]);
+        assert(sharedTree.countWithPrefix("toas") == 3 && sharedTree.hasPrefix("ca") && !sharedTree.hasPrefix("cab"));
+        std::atomic<bool> readersFailed(false);
+        std::thread reader([&]() {
+            for (int round = 0; round < 2000; ++round) {
+                if (!sharedTree.search("toaster") || sharedTree.countWithPrefix("to") < 3) {
+                    readersFailed = true;
+                }
+            }
+        });
+        for (int round = 0; round < 200; ++round) {
+            sharedTree.insert("tomato" + std::to_string(round));
+        }
+        for (int round = 0; round < 200; ++round) {
+            sharedTree.remove("tomato" + std::to_string(round));
+        }
+        reader.join();
+        assert(!readersFailed && sharedTree.size() == sortedWords.size());
+        sharedTree.remove("toast");
+        assert(!sharedTree.search("toast") && sharedTree.search("toaster") && sharedTree.countWithPrefix("toast") == 2);
+        std::vector<std::string> sharedWords;
+        sharedTree.forEachWithPrefix("", [&](const std::string& word) {
+            sharedWords.push_back(word);
+        });
+        assert(sharedWords.size() == sortedWords.size() - 1 && sharedWords.front() == sortedWords.front());
+        log(logFile, "Concurrent tree test passed.\n");
+
+        ConcurrentRadixTree::Snapshot before = sharedTree.snapshot();
+        ConcurrentRadixTree branchTree = sharedTree;
+        sharedTree.insert("tomato");
+        sharedTree.remove("car");
+        branchTree.insert("cart");
+        assert(before.size() == sortedWords.size() - 1 && before["car"] && !before["tomato"] && !before["cart"]);
+        assert(sharedTree["tomato"] && !sharedTree["car"] && !sharedTree["cart"]);
+        assert(branchTree["car"] && branchTree["cart"] && !branchTree["tomato"] && branchTree.countWithPrefix("car") == 2);
+        ConcurrentRadixTree::Snapshot outliving = branchTree.snapshot();
+        branchTree = sharedTree;
+        assert(branchTree["tomato"] && !branchTree["cart"] && outliving["cart"] && outliving.countWithPrefix("ca") == 4);
+        log(logFile, "Snapshot test passed.\n");
+
+        sharedTree.snapshot().save("testshared.rdx");
+        {
+            ConcurrentRadixTree loadedShared;
+            loadedShared.insert("stale");
+            loadedShared.load("testshared.rdx");
+            assert(loadedShared.size() == sharedTree.size() && loadedShared["tomato"] && !loadedShared["stale"] && loadedShared.countWithPrefix("toast") == sharedTree.countWithPrefix("toast"));
+            MappedRadixTree mappedShared("testshared.rdx");
+            assert(mappedShared.size() == sharedTree.size() && mappedShared["tomato"]);
+            bulkTree.save("testshared.rdx");
+            loadedShared.load("testshared.rdx");
+            assert(loadedShared.size() == bulkTree.size() && loadedShared[""] && loadedShared["toasting"]);
+        }
+        std::remove("testshared.rdx");
+
+        std::filesystem::remove_all("testdurable");
+        {
+            DurableRadixTree durableTree("testdurable");
+            assert(durableTree.size() == 0 && durableTree.recovery().replayedRecords == 0);
+            for (const auto& word : sortedWords) {
+                durableTree.insert(word);
+            }
+            assert(durableTree.tryRemove("cats") && !durableTree.tryRemove("cats") && !durableTree.tryInsert("car"));
+        }
+        {
+            DurableRadixTree durableTree("testdurable");
+            DurableRadixTree::RecoveryStatistics recovered = durableTree.recovery();
+            assert(recovered.checkpointWords == 0 && recovered.replayedRecords == sortedWords.size() + 1 && recovered.discardedBytes == 0);
+            assert(durableTree.size() == sortedWords.size() - 1 && !durableTree["cats"] && durableTree[""] && durableTree["toaster"]);
+            durableTree.checkpoint();
+            durableTree.insert("zebra");
+        }
+        {
+            // A crash in the middle of appending a record leaves a torn tail behind.
+            std::filesystem::path newestLog;
+            for (const auto& entry : std::filesystem::directory_iterator("testdurable")) {
+                if (entry.path().extension() == ".wal" && std::filesystem::file_size(entry.path()) > 8) {
+                    newestLog = entry.path();
+                }
+            }
+            std::ofstream torn(newestLog, std::ios::binary | std::ios::app);
+            torn.write("\x07\x00\x00\x00\x01", 5);
+        }
+        {
+            DurableRadixTree::Options durableOptions;
+            durableOptions.synchronous = false;
+            durableOptions.checkpointBytes = 64;
+            DurableRadixTree durableTree("testdurable", durableOptions);
+            DurableRadixTree::RecoveryStatistics recovered = durableTree.recovery();
+            assert(recovered.checkpointWords == sortedWords.size() - 1 && recovered.replayedRecords == 1 && recovered.discardedBytes == 5);
+            assert(durableTree["zebra"] && durableTree.size() == sortedWords.size());
+            for (int i = 0; i < 100; ++i) {
+                durableTree.insert("word" + std::to_string(i));
+            }
+            durableTree.remove("zebra");
+            durableTree.sync();
+        }
+        {
+            DurableRadixTree durableTree("testdurable");
+            assert(durableTree.size() == sortedWords.size() + 99 && durableTree["word99"] && !durableTree["zebra"] && durableTree.countWithPrefix("word") == 100);
+        }
+        std::filesystem::remove_all("testdurable");
+        log(logFile, "Durable tree test passed.\n");
+
+        static_assert(RadixMap<std::string, std::uint32_t>::storesValuesInline, "small values live in the node");
+        static_assert(!RadixMap<std::string, std::string>::storesValuesInline, "large values are allocated");
+        RadixMap<std::string, std::uint32_t> hits;
+        assert(hits.try_emplace("toaster", 1).second && hits.try_emplace("toast", 2).second && hits.try_emplace("", 3).second);
+        assert(!hits.try_emplace("toast", 9).second && *hits.find("toast") == 2);
+        assert(!hits.insert_or_assign("toast", 5).second && hits.at("toast") == 5);
+        ++hits["toasting"];
+        assert(hits.size() == 4 && hits.at("toasting") == 1 && !hits.find("toa") && hits.contains(""));
+        assert(hits.erase("toaster") == 1 && hits.erase("toaster") == 0 && hits.erase("toa") == 0);
+        std::string listed;
+        hits.forEachWithPrefix("toa", [&](const std::string& key, const std::uint32_t& value) {
+            listed += key + "=" + std::to_string(value) + " ";
+        });
+        assert(listed == "toast=5 toasting=1 ");
+        try {
+            hits.at("toaster");
+            assert(false);
+        }
+        catch (const MyException&) {
+        }
+        RadixMap<std::string, std::string> owners;
+        owners.try_emplace("cat", "alice");
+        owners.insert_or_assign("car", std::string("bob"));
+        RadixMap<std::string, std::string> ownersCopy = owners;
+        owners.erase("cat");
+        assert(owners.size() == 1 && ownersCopy.size() == 2 && ownersCopy.at("cat") == "alice" && *owners.find("car") == "bob");
+        RadixMap<std::string, std::string> ownersMoved = std::move(ownersCopy);
+        assert(ownersMoved.size() == 2 && ownersCopy.empty() && !ownersCopy.find("cat"));
+        log(logFile, "Radix map test passed.\n");
+
         log(logFile, "All tests passed successfully!\n");
     }
     catch (const MyException& ex) {